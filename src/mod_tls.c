@@ -35,10 +35,15 @@
 #include "tls_cache.h"
 #include "tls_proto.h"
 #include "tls_filter.h"
+#include "tls_limit.h"
+#include "tls_prewarm.h"
+#include "tls_recorder.h"
+#include "tls_tcpstat.h"
 #include "tls_var.h"
 #include "tls_version.h"
 
 #include "mod_proxy.h"
+#include "mod_status.h"
 
 static void tls_hooks(apr_pool_t *pool);
 
@@ -67,6 +72,7 @@ static int tls_pre_config(apr_pool_t *pconf, apr_pool_t *plog, apr_pool_t *ptemp
 {
     tls_proto_pre_config(pconf, ptemp);
     tls_cache_pre_config(pconf, plog, ptemp);
+    tls_var_pre_config(pconf);
     return OK;
 }
 
@@ -76,6 +82,7 @@ static apr_status_t tls_post_config(apr_pool_t *p, apr_pool_t *plog,
     const char *tls_init_key = "mod_tls_init_counter";
     tls_conf_server_t *sc;
     void *data = NULL;
+    apr_status_t rv;
 
     (void)plog;
     sc = tls_conf_server_get(s);
@@ -100,7 +107,12 @@ static apr_status_t tls_post_config(apr_pool_t *p, apr_pool_t *plog,
                      sc->global->crustls_version);
     }
 
-    return tls_core_init(p, ptemp, s);
+    rv = tls_core_init(p, ptemp, s);
+    if (APR_SUCCESS == rv && data != NULL) {
+        /* not on the dry run, certificates are loaded now */
+        tls_prewarm_benchmark(ptemp, s);
+    }
+    return rv;
 }
 
 static apr_status_t tls_post_proxy_config(
@@ -213,6 +225,17 @@ static apr_status_t tls_post_config_proxy_ssl(
 static void tls_init_child(apr_pool_t *p, server_rec *s)
 {
     tls_cache_init_child(p, s);
+    tls_recorder_init_child(p, s);
+    tls_filter_init_child(p, s);
+    tls_prewarm_child(p, s);
+}
+
+static int tls_status_hook(request_rec *r, int flags)
+{
+    tls_cache_status(r, flags);
+    tls_limit_status(r, flags);
+    tls_tcpstat_status(r, flags);
+    return OK;
 }
 
 static int hook_pre_connection(conn_rec *c, void *csd)
@@ -267,14 +290,17 @@ static void tls_hooks(apr_pool_t *pool)
                       APR_HOOK_MIDDLE);
     ap_hook_post_config(tls_post_proxy_config, dep_proxy, NULL, APR_HOOK_MIDDLE);
     ap_hook_child_init(tls_init_child, NULL,NULL, APR_HOOK_MIDDLE);
+    APR_OPTIONAL_HOOK(ap, status_hook, tls_status_hook, NULL, NULL, APR_HOOK_MIDDLE);
     /* connection things */
     ap_hook_pre_connection(hook_pre_connection, NULL, NULL, APR_HOOK_MIDDLE);
     ap_hook_process_connection(hook_connection, NULL, mod_http2, APR_HOOK_MIDDLE);
+    ap_hook_pre_close_connection(tls_tcpstat_pre_close, NULL, NULL, APR_HOOK_MIDDLE);
     /* request things */
     ap_hook_default_port(tls_hook_default_port, NULL,NULL, APR_HOOK_MIDDLE);
     ap_hook_http_scheme(tls_hook_http_scheme, NULL,NULL, APR_HOOK_MIDDLE);
     ap_hook_post_read_request(tls_core_request_check, dep_req_check, NULL, APR_HOOK_MIDDLE);
     ap_hook_fixups(tls_var_request_fixup, NULL,NULL, APR_HOOK_MIDDLE);
+    ap_hook_handler(tls_recorder_handler, NULL, NULL, APR_HOOK_MIDDLE);
 
     ap_hook_ssl_conn_is_ssl(tls_conn_check_ssl, NULL, NULL, APR_HOOK_MIDDLE);
     ap_hook_ssl_var_lookup(tls_var_lookup, NULL, NULL, APR_HOOK_MIDDLE);
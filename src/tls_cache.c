@@ -23,6 +23,7 @@
 #include <http_log.h>
 #include <ap_socache.h>
 #include <util_mutex.h>
+#include <mod_status.h>
 
 #include <rustls.h>
 
@@ -37,6 +38,7 @@ APLOG_USE_MODULE(tls);
 #define TLS_CACHE_DEF_DIR           "tls"
 #define TLS_CACHE_DEF_FILE          "session_cache"
 #define TLS_CACHE_DEF_SIZE          512000
+#define TLS_CACHE_PART_DEF_SIZE     64000
 
 static const char *cache_provider_unknown(const char *name, apr_pool_t *p)
 {
@@ -62,12 +64,54 @@ void tls_cache_pre_config(apr_pool_t *pconf, apr_pool_t *plog, apr_pool_t *ptemp
     ap_mutex_register(pconf, TLS_SESSION_CACHE_MUTEX_TYPE, NULL, APR_LOCK_DEFAULT, 0);
 }
 
-static const char *cache_init(tls_conf_global_t *gconf, apr_pool_t *p, apr_pool_t *ptemp)
+static const char *cache_create(
+    const char *spec, const char *mutex_id, server_rec *s,
+    const ap_socache_provider_t **pprovider, ap_socache_instance_t **pcache,
+    apr_global_mutex_t **pmutex, apr_pool_t *p, apr_pool_t *ptemp)
 {
     const char *err = NULL;
     const char *name, *args = NULL;
     apr_status_t rv;
 
+    name = spec;
+    args = ap_strchr((char*)name, ':');
+    if (args) {
+        name = apr_pstrmemdup(p, name, (apr_size_t)(args - name));
+        ++args;
+    }
+    *pprovider = ap_lookup_provider(AP_SOCACHE_PROVIDER_GROUP,
+                                    name, AP_SOCACHE_PROVIDER_VERSION);
+    if (!*pprovider) {
+        err = cache_provider_unknown(name, p);
+        goto cleanup;
+    }
+    err = (*pprovider)->create(pcache, args, ptemp, p);
+    if (err != NULL) goto cleanup;
+
+    if ((*pprovider)->flags & AP_SOCACHE_FLAG_NOTMPSAFE && !*pmutex) {
+        /* we need a global lock to access the cache */
+        rv = ap_global_mutex_create(pmutex, NULL,
+            TLS_SESSION_CACHE_MUTEX_TYPE, mutex_id, s, p, 0);
+        if (APR_SUCCESS != rv) {
+            err = apr_psprintf(p, "error setting up global %s mutex: %d",
+                TLS_SESSION_CACHE_MUTEX_TYPE, rv);
+            *pmutex = NULL;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    if (NULL != err) {
+        *pprovider = NULL;
+        *pcache = NULL;
+    }
+    return err;
+}
+
+static const char *cache_init(tls_conf_global_t *gconf, apr_pool_t *p, apr_pool_t *ptemp)
+{
+    const char *err = NULL;
+
     if (gconf->session_cache) {
         goto cleanup;
     }
@@ -91,39 +135,31 @@ static const char *cache_init(tls_conf_global_t *gconf, apr_pool_t *p, apr_pool_
 
     ap_log_error(APLOG_MARK, APLOG_DEBUG, 0, gconf->ap_server, APLOGNO(10347)
                  "Using session cache: %s", gconf->session_cache_spec);
-    name = gconf->session_cache_spec;
-    args = ap_strchr((char*)name, ':');
-    if (args) {
-        name = apr_pstrmemdup(p, name, (apr_size_t)(args - name));
-        ++args;
-    }
-    gconf->session_cache_provider = ap_lookup_provider(AP_SOCACHE_PROVIDER_GROUP,
-                                                       name, AP_SOCACHE_PROVIDER_VERSION);
-    if (!gconf->session_cache_provider) {
-        err = cache_provider_unknown(name, p);
+    err = cache_create(gconf->session_cache_spec, NULL, gconf->ap_server,
+                       &gconf->session_cache_provider, &gconf->session_cache,
+                       &gconf->session_cache_mutex, p, ptemp);
+
+cleanup:
+    return err;
+}
+
+static const char *partition_init(
+    tls_cache_partition_t *part, tls_conf_global_t *gconf, apr_pool_t *p, apr_pool_t *ptemp)
+{
+    const char *err = NULL;
+
+    if (part->cache || !strcmp(TLS_SESSION_PARTITION_NONE, part->name)) {
         goto cleanup;
     }
-    err = gconf->session_cache_provider->create(&gconf->session_cache, args, ptemp, p);
-    if (err != NULL) goto cleanup;
-
-    if (gconf->session_cache_provider->flags & AP_SOCACHE_FLAG_NOTMPSAFE
-        && !gconf->session_cache_mutex) {
-        /* we need a global lock to access the cache */
-        rv = ap_global_mutex_create(&gconf->session_cache_mutex, NULL,
-            TLS_SESSION_CACHE_MUTEX_TYPE, NULL, gconf->ap_server, p, 0);
-        if (APR_SUCCESS != rv) {
-            err = apr_psprintf(p, "error setting up global %s mutex: %d",
-                TLS_SESSION_CACHE_MUTEX_TYPE, rv);
-            gconf->session_cache_mutex = NULL;
-            goto cleanup;
-        }
+    if (!part->spec) {
+        part->spec = apr_psprintf(p, "%s:mod_tls-sess-%s(%ld)",
+            TLS_CACHE_DEF_PROVIDER, part->name, (long)TLS_CACHE_PART_DEF_SIZE);
     }
-
+    ap_log_error(APLOG_MARK, APLOG_DEBUG, 0, gconf->ap_server, APLOGNO(10386)
+                 "Using session cache partition %s: %s", part->name, part->spec);
+    err = cache_create(part->spec, part->name, gconf->ap_server,
+                       &part->provider, &part->cache, &part->mutex, p, ptemp);
 cleanup:
-    if (NULL != err) {
-        gconf->session_cache_provider = NULL;
-        gconf->session_cache = NULL;
-    }
     return err;
 }
 
@@ -134,9 +170,52 @@ const char *tls_cache_set_specification(
     return cache_init(gconf, p, ptemp);
 }
 
+const char *tls_cache_set_partition(
+    const char *name, const char *spec, tls_conf_server_t *sc, apr_pool_t *p)
+{
+    tls_cache_partition_t *part;
+    const char *c;
+
+    for (c = name; *c; ++c) {
+        if (!apr_isalnum(*c) && *c != '-' && *c != '_' && *c != '.') {
+            return apr_pstrcat(p, "invalid character in partition name '", name,
+                               "', use only letters, digits, '-', '_' and '.'", NULL);
+        }
+    }
+    if (!*name) return "partition name must not be empty";
+
+    if (!strcasecmp(TLS_SESSION_PARTITION_NONE, name)) {
+        if (spec) return "the partition 'none' selects the shared session cache, "
+                         "it cannot have a cache specification";
+        name = TLS_SESSION_PARTITION_NONE;
+    }
+    part = apr_hash_get(sc->global->session_partitions, name, APR_HASH_KEY_STRING);
+    if (!part) {
+        part = apr_pcalloc(p, sizeof(*part));
+        part->name = apr_pstrdup(p, name);
+        apr_hash_set(sc->global->session_partitions, part->name, APR_HASH_KEY_STRING, part);
+    }
+    if (spec) {
+        const char *pname = spec, *args = ap_strchr_c(spec, ':');
+
+        if (args) pname = apr_pstrmemdup(p, spec, (apr_size_t)(args - spec));
+        if (!ap_lookup_provider(AP_SOCACHE_PROVIDER_GROUP, pname, AP_SOCACHE_PROVIDER_VERSION)) {
+            return cache_provider_unknown(pname, p);
+        }
+        if (part->spec && strcmp(part->spec, spec)) {
+            return apr_pstrcat(p, "partition '", name, "' has already been defined as '",
+                               part->spec, "'", NULL);
+        }
+        part->spec = spec;
+    }
+    sc->session_partition = part;
+    return NULL;
+}
+
 apr_status_t tls_cache_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec *s)
 {
     tls_conf_server_t *sc = tls_conf_server_get(s);
+    apr_hash_index_t *hi;
     const char *err;
     apr_status_t rv = APR_SUCCESS;
 
@@ -164,20 +243,53 @@ apr_status_t tls_cache_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec
         if (APR_SUCCESS != rv) {
             ap_log_error(APLOG_MARK, APLOG_EMERG, 0, s, APLOGNO(10349)
                          "error initializing session cache.");
+            goto cleanup;
+        }
+    }
+
+    for (hi = apr_hash_first(ptemp, sc->global->session_partitions); hi; hi = apr_hash_next(hi)) {
+        tls_cache_partition_t *part = apr_hash_this_val(hi);
+        struct ap_socache_hints hints;
+
+        err = partition_init(part, sc->global, p, ptemp);
+        if (err) {
+            /* servers name a partition to keep their sessions apart,
+             * silently running them without one is not what they asked for. */
+            ap_log_error(APLOG_MARK, APLOG_EMERG, 0, s, APLOGNO(10387)
+                         "session cache partition %s [%s] could not be initialized: %s",
+                         part->name, part->spec, err);
+            rv = APR_EGENERAL;
+            goto cleanup;
+        }
+        if (!part->cache) continue;
+
+        ap_log_error(APLOG_MARK, APLOG_TRACE1, 0, s, "provider init session cache partition %s [%s]",
+                     part->name, part->spec);
+        memset(&hints, 0, sizeof(hints));
+        hints.avg_obj_size = 100;
+        hints.avg_id_len = 33;
+        hints.expiry_interval = 30;
+
+        rv = part->provider->init(part->cache,
+            apr_pstrcat(p, "mod_tls-sess-", part->name, NULL), &hints, s, p);
+        if (APR_SUCCESS != rv) {
+            ap_log_error(APLOG_MARK, APLOG_EMERG, rv, s, APLOGNO(10388)
+                         "error initializing session cache partition %s.", part->name);
+            goto cleanup;
         }
     }
+cleanup:
     return rv;
 }
 
-void tls_cache_init_child(apr_pool_t *p, server_rec *s)
+static void mutex_init_child(apr_global_mutex_t **pmutex, apr_pool_t *p, server_rec *s)
 {
-    tls_conf_server_t *sc = tls_conf_server_get(s);
     const char *lockfile;
     apr_status_t rv;
 
-    if (sc->global->session_cache_mutex) {
-        lockfile = apr_global_mutex_lockfile(sc->global->session_cache_mutex);
-        rv = apr_global_mutex_child_init(&sc->global->session_cache_mutex, lockfile, p);
+    if (*pmutex) {
+        lockfile = apr_global_mutex_lockfile(*pmutex);
+        rv = apr_global_mutex_child_init(pmutex, lockfile, p);
         if (APR_SUCCESS != rv) {
             ap_log_error(APLOG_MARK, APLOG_ERR, rv, s, APLOGNO(10350)
                          "Cannot reinit %s mutex (file `%s`)",
@@ -186,31 +298,75 @@ void tls_cache_init_child(apr_pool_t *p, server_rec *s)
     }
 }
 
+void tls_cache_init_child(apr_pool_t *p, server_rec *s)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    apr_hash_index_t *hi;
+
+    mutex_init_child(&sc->global->session_cache_mutex, p, s);
+    for (hi = apr_hash_first(p, sc->global->session_partitions); hi; hi = apr_hash_next(hi)) {
+        tls_cache_partition_t *part = apr_hash_this_val(hi);
+        mutex_init_child(&part->mutex, p, s);
+    }
+}
+
 void tls_cache_free(server_rec *s)
 {
     tls_conf_server_t *sc = tls_conf_server_get(s);
+    apr_hash_index_t *hi;
+
     if (sc->global->session_cache_provider) {
         sc->global->session_cache_provider->destroy(sc->global->session_cache, s);
     }
+    for (hi = apr_hash_first(NULL, sc->global->session_partitions); hi; hi = apr_hash_next(hi)) {
+        tls_cache_partition_t *part = apr_hash_this_val(hi);
+        if (part->provider && part->cache) {
+            part->provider->destroy(part->cache, s);
+            part->cache = NULL;
+        }
+    }
+}
+
+static tls_cache_partition_t *shared_get(tls_conf_global_t *gconf, tls_cache_partition_t *shared)
+{
+    memset(shared, 0, sizeof(*shared));
+    shared->name = TLS_SESSION_PARTITION_NONE;
+    shared->spec = gconf->session_cache_spec;
+    shared->provider = gconf->session_cache_provider;
+    shared->cache = gconf->session_cache;
+    shared->mutex = gconf->session_cache_mutex;
+    return shared;
+}
+
+/* Get the cache to use for a server. This is either the partition the
+ * server has been assigned to or, without one, the shared session cache
+ * which is returned in `shared`. */
+static tls_cache_partition_t *cache_get(tls_conf_server_t *sc, tls_cache_partition_t *shared)
+{
+    if (sc->session_partition
+        && strcmp(TLS_SESSION_PARTITION_NONE, sc->session_partition->name)) {
+        return sc->session_partition;
+    }
+    return shared_get(sc->global, shared);
 }
 
-static void tls_cache_lock(tls_conf_global_t *gconf)
+static void tls_cache_lock(tls_cache_partition_t *part, server_rec *s)
 {
-    if (gconf->session_cache_mutex) {
-        apr_status_t rv = apr_global_mutex_lock(gconf->session_cache_mutex);
+    if (part->mutex) {
+        apr_status_t rv = apr_global_mutex_lock(part->mutex);
         if (APR_SUCCESS != rv) {
-            ap_log_error(APLOG_MARK, APLOG_WARNING, rv, gconf->ap_server, APLOGNO(10351)
+            ap_log_error(APLOG_MARK, APLOG_WARNING, rv, s, APLOGNO(10351)
                          "Failed to acquire TLS session cache lock");
         }
     }
 }
 
-static void tls_cache_unlock(tls_conf_global_t *gconf)
+static void tls_cache_unlock(tls_cache_partition_t *part, server_rec *s)
 {
-    if (gconf->session_cache_mutex) {
-        apr_status_t rv = apr_global_mutex_unlock(gconf->session_cache_mutex);
+    if (part->mutex) {
+        apr_status_t rv = apr_global_mutex_unlock(part->mutex);
         if (APR_SUCCESS != rv) {
-            ap_log_error(APLOG_MARK, APLOG_WARNING, rv, gconf->ap_server, APLOGNO(10352)
+            ap_log_error(APLOG_MARK, APLOG_WARNING, rv, s, APLOGNO(10352)
                          "Failed to release TLS session cache lock");
         }
     }
@@ -227,30 +383,32 @@ static rustls_result tls_cache_get(
     conn_rec *c = userdata;
     tls_conf_conn_t *cc = tls_conf_conn_get(c);
     tls_conf_server_t *sc = tls_conf_server_get(cc->server);
+    tls_cache_partition_t shared, *part;
     apr_status_t rv = APR_ENOENT;
     unsigned int vlen, klen;
     const unsigned char *kdata;
 
-    if (!sc->global->session_cache) goto not_found;
-    tls_cache_lock(sc->global);
+    part = cache_get(sc, &shared);
+    if (!part->cache) goto not_found;
+    tls_cache_lock(part, cc->server);
 
     kdata = key->data;
     klen = (unsigned int)key->len;
     vlen = (unsigned int)count;
-    rv = sc->global->session_cache_provider->retrieve(
-        sc->global->session_cache, cc->server, kdata, klen, buf, &vlen, c->pool);
+    rv = part->provider->retrieve(
+        part->cache, cc->server, kdata, klen, buf, &vlen, c->pool);
 
     if (APLOGctrace4(c)) {
         apr_ssize_t n = klen;
-        ap_log_cerror(APLOG_MARK, APLOG_TRACE4, rv, c, "retrieve key %d[%8x], found %d val",
-            klen, apr_hashfunc_default((const char*)kdata, &n), vlen);
+        ap_log_cerror(APLOG_MARK, APLOG_TRACE4, rv, c, "retrieve key %d[%8x] in %s, found %d val",
+            klen, apr_hashfunc_default((const char*)kdata, &n), part->name, vlen);
     }
     if (remove_after || (APR_SUCCESS != rv && !APR_STATUS_IS_NOTFOUND(rv))) {
-        sc->global->session_cache_provider->remove(
-            sc->global->session_cache, cc->server, key->data, klen, c->pool);
+        part->provider->remove(
+            part->cache, cc->server, key->data, klen, c->pool);
     }
 
-    tls_cache_unlock(sc->global);
+    tls_cache_unlock(part, cc->server);
     if (APR_SUCCESS != rv) goto not_found;
     cc->session_id_cache_hit = 1;
     *out_n = (size_t)vlen;
@@ -269,26 +427,28 @@ static rustls_result tls_cache_put(
     conn_rec *c = userdata;
     tls_conf_conn_t *cc = tls_conf_conn_get(c);
     tls_conf_server_t *sc = tls_conf_server_get(cc->server);
+    tls_cache_partition_t shared, *part;
     apr_status_t rv = APR_ENOENT;
     apr_time_t expires_at;
     unsigned int klen, vlen;
     const unsigned char *kdata;
 
-    if (!sc->global->session_cache) goto not_stored;
-    tls_cache_lock(sc->global);
+    part = cache_get(sc, &shared);
+    if (!part->cache) goto not_stored;
+    tls_cache_lock(part, cc->server);
 
     expires_at = apr_time_now() + apr_time_from_sec(300);
     kdata = key->data;
     klen = (unsigned int)key->len;
     vlen = (unsigned int)val->len;
-    rv = sc->global->session_cache_provider->store(sc->global->session_cache, cc->server,
-                                                   kdata, klen, expires_at,
-                                                   (unsigned char*)val->data, vlen, c->pool);
+    rv = part->provider->store(part->cache, cc->server,
+                               kdata, klen, expires_at,
+                               (unsigned char*)val->data, vlen, c->pool);
     if (APLOGctrace4(c)) {
         ap_log_cerror(APLOG_MARK, APLOG_TRACE4, rv, c,
-            "stored %d key bytes, with %d val bytes", klen, vlen);
+            "stored %d key bytes in %s, with %d val bytes", klen, part->name, vlen);
     }
-    tls_cache_unlock(sc->global);
+    tls_cache_unlock(part, cc->server);
     if (APR_SUCCESS != rv) goto not_stored;
     return RUSTLS_RESULT_OK;
 
@@ -300,11 +460,54 @@ apr_status_t tls_cache_init_server(
     rustls_server_config_builder *builder, server_rec *s)
 {
     tls_conf_server_t *sc = tls_conf_server_get(s);
+    tls_cache_partition_t shared, *part;
 
-    if (sc && sc->global->session_cache) {
-        ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s, "adding session persistence to rustls");
+    part = sc? cache_get(sc, &shared) : NULL;
+    if (part && part->cache) {
+        ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s,
+                     "adding session persistence (partition %s) to rustls", part->name);
         rustls_server_config_builder_set_persistence(
             builder, tls_cache_get, tls_cache_put);
     }
     return APR_SUCCESS;
 }
+
+static void cache_status(request_rec *r, int flags, tls_cache_partition_t *part)
+{
+    if (!part->cache) return;
+    if (flags & AP_STATUS_SHORT) {
+        ap_rprintf(r, "TLSSessionCachePartition: %s\n", part->name);
+    }
+    else {
+        ap_rprintf(r, "<tr><td><b>TLS session cache %s</b>: %s</td></tr>\n",
+                   ap_escape_html(r->pool, part->name), ap_escape_html(r->pool, part->spec));
+        ap_rputs("<tr><td>", r);
+    }
+    tls_cache_lock(part, r->server);
+    part->provider->status(part->cache, r, flags);
+    tls_cache_unlock(part, r->server);
+    if (!(flags & AP_STATUS_SHORT)) {
+        ap_rputs("</td></tr>\n", r);
+    }
+}
+
+void tls_cache_status(request_rec *r, int flags)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(r->server);
+    tls_cache_partition_t shared;
+    apr_hash_index_t *hi;
+
+    if (!(flags & AP_STATUS_SHORT)) {
+        ap_rputs("<hr>\n<h2>TLS Session Caches</h2>\n<table>\n", r);
+    }
+    cache_status(r, flags, shared_get(sc->global, &shared));
+    for (hi = apr_hash_first(r->pool, sc->global->session_partitions); hi; hi = apr_hash_next(hi)) {
+        tls_cache_partition_t *part = apr_hash_this_val(hi);
+        if (strcmp(TLS_SESSION_PARTITION_NONE, part->name)) {
+            cache_status(r, flags, part);
+        }
+    }
+    if (!(flags & AP_STATUS_SHORT)) {
+        ap_rputs("</table>\n", r);
+    }
+}
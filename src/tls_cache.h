@@ -19,6 +19,24 @@
 /* name of the global session cache mutex, should we need it */
 #define TLS_SESSION_CACHE_MUTEX_TYPE    "tls-session-cache"
 
+/* name of the partition that selects the shared session cache */
+#define TLS_SESSION_PARTITION_NONE      "none"
+
+/**
+ * A session cache partition. Servers assigned to the same partition share
+ * a session cache instance of their own, separate from the global one and
+ * from all other partitions. The capacity of the partition is determined by
+ * its cache specification, so a busy partition can only evict its own sessions.
+ */
+typedef struct tls_cache_partition_t tls_cache_partition_t;
+struct tls_cache_partition_t {
+    const char *name;                 /* name of the partition */
+    const char *spec;                 /* the cache specification, NULL for default */
+    const struct ap_socache_provider_t *provider; /* provider used for the partition */
+    struct ap_socache_instance_t *cache; /* partition cache instance */
+    struct apr_global_mutex_t *mutex; /* global mutex for access, if needed */
+};
+
 
 /**
  * Set the specification of the session cache to use. The syntax is
@@ -33,6 +51,21 @@
 const char *tls_cache_set_specification(
     const char *spec, tls_conf_global_t *gconf, apr_pool_t *p, apr_pool_t *ptemp);
 
+/**
+ * Assign a session cache partition to a server. The partition is created
+ * if it does not exist yet. If `spec` is not NULL, it defines the cache used
+ * for the partition, with the same syntax as `tls_cache_set_specification()`.
+ * A partition may only be specified once.
+ *
+ * @param name the name of the partition or "none" for the shared cache
+ * @param spec the cache specification or NULL
+ * @param sc the server configuration to assign the partition to
+ * @param p pool for permanent allocations
+ * @return NULL on success or an error message
+ */
+const char *tls_cache_set_partition(
+    const char *name, const char *spec, tls_conf_server_t *sc, apr_pool_t *p);
+
 /**
  * Setup before configuration runs, announces our potential global mutex.
  */
@@ -60,4 +93,10 @@ void tls_cache_free(server_rec *s);
 apr_status_t tls_cache_init_server(
     rustls_server_config_builder *builder, server_rec *s);
 
+/**
+ * Report the status of the shared session cache and all partitions
+ * for mod_status.
+ */
+void tls_cache_status(request_rec *r, int flags);
+
 #endif /* tls_cache_h */
\ No newline at end of file
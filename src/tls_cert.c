@@ -26,6 +26,7 @@
 #include <rustls.h>
 
 #include "tls_cert.h"
+#include "tls_proto.h"
 #include "tls_util.h"
 
 extern module AP_MODULE_DECLARE_DATA tls_module;
@@ -145,18 +146,31 @@ static void nullify_key_pem(tls_cert_pem_t *pems)
 }
 
 static apr_status_t make_certified_key(
-    apr_pool_t *p, const char *name,
+    apr_pool_t *p, const char *name, const tls_provider_t *provider,
     const tls_data_t *cert_pem, const tls_data_t *pkey_pem,
     const rustls_certified_key **pckey)
 {
     const rustls_certified_key *ckey = NULL;
+    rustls_signing_key *signing_key = NULL;
     rustls_result rr = RUSTLS_RESULT_OK;
     apr_status_t rv = APR_SUCCESS;
 
-    rr = rustls_certified_key_build(
-        cert_pem->data, cert_pem->len,
-        pkey_pem->data, pkey_pem->len,
-        &ckey);
+    if (provider) {
+        /* sign with the provider that does the rest of the handshake */
+        rr = rustls_crypto_provider_load_key(
+            provider->provider, pkey_pem->data, pkey_pem->len, &signing_key);
+        if (RUSTLS_RESULT_OK == rr) {
+            rr = rustls_certified_key_build_with_signing_key(
+                cert_pem->data, cert_pem->len, signing_key, &ckey);
+        }
+        if (signing_key) rustls_signing_key_free(signing_key);
+    }
+    else {
+        rr = rustls_certified_key_build(
+            cert_pem->data, cert_pem->len,
+            pkey_pem->data, pkey_pem->len,
+            &ckey);
+    }
 
     if (RUSTLS_RESULT_OK != rr) {
         const char *err_descr;
@@ -175,7 +189,7 @@ static apr_status_t make_certified_key(
 }
 
 apr_status_t tls_cert_load_cert_key(
-    apr_pool_t *p, const tls_cert_spec_t *spec,
+    apr_pool_t *p, const tls_cert_spec_t *spec, const tls_provider_t *provider,
     const char **pcert_pem, const rustls_certified_key **pckey)
 {
     apr_status_t rv = APR_SUCCESS;
@@ -186,7 +200,7 @@ apr_status_t tls_cert_load_cert_key(
         rv = tls_cert_load_pem(p, spec, &pems);
         if (APR_SUCCESS != rv) goto cleanup;
         if (pcert_pem) *pcert_pem = tls_data_to_str(p, &pems->cert_pem);
-        rv = make_certified_key(p, spec->cert_file, &pems->cert_pem, &pems->pkey_pem, pckey);
+        rv = make_certified_key(p, spec->cert_file, provider, &pems->cert_pem, &pems->pkey_pem, pckey);
         /* dont want them hanging around in memory unnecessarily. */
         nullify_key_pem(pems);
     }
@@ -200,7 +214,7 @@ apr_status_t tls_cert_load_cert_key(
             pkey_pem = pem;
         }
         if (pcert_pem) *pcert_pem = spec->cert_pem;
-        rv = make_certified_key(p, "memory", &pem, &pkey_pem, pckey);
+        rv = make_certified_key(p, "memory", provider, &pem, &pkey_pem, pckey);
         /* pems provided from outside are responsibility of the caller */
     }
     else {
@@ -265,26 +279,29 @@ static const char *cert_spec_to_id(const tls_cert_spec_t *spec)
 
 apr_status_t tls_cert_reg_get_certified_key(
     tls_cert_reg_t *reg, server_rec *s, const tls_cert_spec_t *spec,
-    const rustls_certified_key **pckey)
+    const tls_provider_t *provider, const rustls_certified_key **pckey)
 {
     apr_status_t rv = APR_SUCCESS;
-    const char *id;
+    const char *id, *reg_key;
     tls_cert_reg_entry_t *entry;
 
     id = cert_spec_to_id(spec);
     assert(id);
-    entry = apr_hash_get(reg->id2entry, id, APR_HASH_KEY_STRING);
+    /* a key loaded by another provider is another entry, the id stays
+     * the certificate's, as OCSP stapling knows it by that. */
+    reg_key = provider? apr_pstrcat(reg->pool, provider->name, ":", id, NULL) : id;
+    entry = apr_hash_get(reg->id2entry, reg_key, APR_HASH_KEY_STRING);
     if (!entry) {
         const rustls_certified_key *certified_key;
         const char *cert_pem;
-        rv = tls_cert_load_cert_key(reg->pool, spec, &cert_pem, &certified_key);
+        rv = tls_cert_load_cert_key(reg->pool, spec, provider, &cert_pem, &certified_key);
         if (APR_SUCCESS != rv) goto cleanup;
         entry = apr_pcalloc(reg->pool, sizeof(*entry));
         entry->id = apr_pstrdup(reg->pool, id);
         entry->cert_pem = cert_pem;
         entry->server = s;
         entry->certified_key = certified_key;
-        apr_hash_set(reg->id2entry, entry->id, APR_HASH_KEY_STRING, entry);
+        apr_hash_set(reg->id2entry, provider? reg_key : entry->id, APR_HASH_KEY_STRING, entry);
         /* associates the pointer value */
         apr_hash_set(reg->key2entry, &entry->certified_key, sizeof(entry->certified_key), entry);
     }
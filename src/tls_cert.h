@@ -18,6 +18,8 @@
 
 #include "tls_util.h"
 
+struct tls_provider_t;
+
 /**
  * The PEM data of a certificate and its key.
  */
@@ -49,11 +51,12 @@ apr_status_t tls_cert_to_pem(const char **ppem, apr_pool_t *p, const rustls_cert
  * The returned `rustls_certified_key` is owned by the caller.
  * @param p the memory pool to use
  * @param spec the specification for the certificate (file or PEM data)
+ * @param provider the crypto provider to load the private key with, NULL for the default one
  * @param cert_pem return the PEM data used for loading the certificates, optional
  * @param pckey the loaded certified key on return
  */
 apr_status_t tls_cert_load_cert_key(
-    apr_pool_t *p, const tls_cert_spec_t *spec,
+    apr_pool_t *p, const tls_cert_spec_t *spec, const struct tls_provider_t *provider,
     const char **pcert_pem, const rustls_certified_key **pckey);
 
 /**
@@ -80,15 +83,17 @@ apr_size_t tls_cert_reg_count(tls_cert_reg_t *reg);
 
 /**
  * Get a the `rustls_certified_key` identified by `spec` from the registry.
- * This will load the key the first time it is requested.
+ * This will load the key the first time it is requested for `provider`.
  * The returned `rustls_certified_key` is owned by the registry.
  * @param reg the certified key registry
  * @param s the server_rec this is loaded into, useful for error logging
  * @param spec the specification of the certified key
+ * @param provider the crypto provider to load the private key with, NULL for the default one
  * @param pckey the certified key instance on return
  */
 apr_status_t tls_cert_reg_get_certified_key(
-    tls_cert_reg_t *reg, server_rec *s, const tls_cert_spec_t *spec, const rustls_certified_key **pckey);
+    tls_cert_reg_t *reg, server_rec *s, const tls_cert_spec_t *spec,
+    const struct tls_provider_t *provider, const rustls_certified_key **pckey);
 
 /**
  * Visit all certified keys in the registry.
@@ -61,6 +61,12 @@ static tls_conf_global_t *conf_global_get_or_make(apr_pool_t *pool, server_rec *
     gconf->var_lookups = apr_hash_make(pool);
     tls_var_init_lookup_hash(pool, gconf->var_lookups);
     gconf->session_cache_spec = "default";
+    gconf->session_partitions = apr_hash_make(pool);
+    gconf->recorder_slow = apr_time_from_msec(500);
+    gconf->pipeline_depth = 4;
+    gconf->hs_limit_v4_prefix = 32;
+    gconf->hs_limit_v6_prefix = 64;
+    gconf->hs_limit_max_delayed = 16;
 
     return gconf;
 }
@@ -88,6 +94,8 @@ void *tls_conf_create_svr(apr_pool_t *pool, server_rec *s)
     conf->honor_client_order = TLS_FLAG_UNSET;
     conf->strict_sni = TLS_FLAG_UNSET;
     conf->tls_protocol_min = TLS_FLAG_UNSET;
+    conf->buffer_min = TLS_FLAG_UNSET;
+    conf->buffer_max = TLS_FLAG_UNSET;
     conf->tls_pref_ciphers = apr_array_make(pool, 3, sizeof(apr_uint16_t));;
     conf->tls_supp_ciphers = apr_array_make(pool, 3, sizeof(apr_uint16_t));;
     return conf;
@@ -113,7 +121,12 @@ void *tls_conf_merge_svr(apr_pool_t *pool, void *basev, void *addv)
         add->tls_pref_ciphers : base->tls_pref_ciphers;
     nconf->tls_supp_ciphers = add->tls_supp_ciphers->nelts?
         add->tls_supp_ciphers : base->tls_supp_ciphers;
+    nconf->crypto_provider = add->crypto_provider? add->crypto_provider : base->crypto_provider;
     nconf->honor_client_order = MERGE_INT(base, add, honor_client_order);
+    nconf->session_partition = add->session_partition?
+        add->session_partition : base->session_partition;
+    nconf->buffer_min = MERGE_INT(base, add, buffer_min);
+    nconf->buffer_max = MERGE_INT(base, add, buffer_max);
     nconf->client_ca = add->client_ca? add->client_ca : base->client_ca;
     nconf->client_auth = (add->client_auth != TLS_CLIENT_AUTH_UNSET)?
         add->client_auth : base->client_auth;
@@ -151,9 +164,55 @@ void *tls_conf_create_dir(apr_pool_t *pool, char *dir)
 }
 
 
-static int same_proxy_settings(tls_conf_dir_t *a, tls_conf_dir_t *b)
+static int same_str(const char *a, const char *b)
 {
-    return a->proxy_ca == b->proxy_ca;
+    return (a == b) || (a && b && !strcmp(a, b));
+}
+
+static int same_proxy_ca(const char *a, const char *b)
+{
+    /* "default" and not configured both mean: no trust anchors */
+    if (a && !strcasecmp(a, "default")) a = NULL;
+    if (b && !strcasecmp(b, "default")) b = NULL;
+    return same_str(a, b);
+}
+
+static int same_ids(const apr_array_header_t *a, const apr_array_header_t *b)
+{
+    if (a == b) return 1;
+    if (a->nelts != b->nelts) return 0;
+    return !memcmp(a->elts, b->elts, (size_t)a->nelts * sizeof(apr_uint16_t));
+}
+
+static int same_cert_specs(const apr_array_header_t *a, const apr_array_header_t *b)
+{
+    const tls_cert_spec_t *sa, *sb;
+    int i;
+
+    if (a == b) return 1;
+    if (a->nelts != b->nelts) return 0;
+    for (i = 0; i < a->nelts; ++i) {
+        sa = APR_ARRAY_IDX(a, i, const tls_cert_spec_t*);
+        sb = APR_ARRAY_IDX(b, i, const tls_cert_spec_t*);
+        if (sa == sb) continue;
+        if (!same_str(sa->cert_file, sb->cert_file)
+            || !same_str(sa->pkey_file, sb->pkey_file)
+            || !same_str(sa->cert_pem, sb->cert_pem)
+            || !same_str(sa->pkey_pem, sb->pkey_pem)) return 0;
+    }
+    return 1;
+}
+
+/* Return != 0 iff the proxy configuration `pc` has the same settings as
+ * the ones in directory config `dc`, so it may be used for it. */
+static int same_proxy_settings(const tls_conf_proxy_t *pc, const tls_conf_dir_t *dc)
+{
+    return same_proxy_ca(pc->proxy_ca, dc->proxy_ca)
+        && pc->proxy_protocol_min == dc->proxy_protocol_min
+        && same_ids(pc->proxy_pref_ciphers, dc->proxy_pref_ciphers)
+        && same_ids(pc->proxy_supp_ciphers, dc->proxy_supp_ciphers)
+        && pc->crypto_provider == dc->proxy_crypto_provider
+        && same_cert_specs(pc->machine_cert_specs, dc->proxy_machine_cert_specs);
 }
 
 static void dir_assign_merge(
@@ -171,14 +230,18 @@ static void dir_assign_merge(
         add->proxy_pref_ciphers : base->proxy_pref_ciphers;
     local.proxy_supp_ciphers = add->proxy_supp_ciphers->nelts?
         add->proxy_supp_ciphers : base->proxy_supp_ciphers;
+    local.proxy_crypto_provider = add->proxy_crypto_provider?
+        add->proxy_crypto_provider : base->proxy_crypto_provider;
     local.proxy_machine_cert_specs = apr_array_append(pool,
         base->proxy_machine_cert_specs, add->proxy_machine_cert_specs);
     if (local.proxy_enabled == TLS_FLAG_TRUE) {
         if (add->proxy_config) {
-            local.proxy_config = same_proxy_settings(&local, add)? add->proxy_config : NULL;
+            local.proxy_config = same_proxy_settings(add->proxy_config, &local)?
+                add->proxy_config : NULL;
         }
         else if (base->proxy_config) {
-            local.proxy_config = same_proxy_settings(&local, base)? add->proxy_config : NULL;
+            local.proxy_config = same_proxy_settings(base->proxy_config, &local)?
+                base->proxy_config : NULL;
         }
     }
     memcpy(dest, &local, sizeof(*dest));
@@ -207,6 +270,8 @@ apr_status_t tls_conf_server_apply_defaults(tls_conf_server_t *sc, apr_pool_t *p
     if (sc->tls_protocol_min == TLS_FLAG_UNSET) sc->tls_protocol_min = 0;
     if (sc->honor_client_order == TLS_FLAG_UNSET) sc->honor_client_order = TLS_FLAG_TRUE;
     if (sc->strict_sni == TLS_FLAG_UNSET) sc->strict_sni = TLS_FLAG_TRUE;
+    if (sc->buffer_min == TLS_FLAG_UNSET) sc->buffer_min = 0;
+    if (sc->buffer_max == TLS_FLAG_UNSET) sc->buffer_max = 0;
     if (sc->client_auth == TLS_CLIENT_AUTH_UNSET) sc->client_auth = TLS_CLIENT_AUTH_NONE;
     return APR_SUCCESS;
 }
@@ -230,11 +295,34 @@ tls_conf_proxy_t *tls_conf_proxy_make(
     pc->proxy_protocol_min = dc->proxy_protocol_min;
     pc->proxy_pref_ciphers = dc->proxy_pref_ciphers;
     pc->proxy_supp_ciphers = dc->proxy_supp_ciphers;
+    pc->crypto_provider = dc->proxy_crypto_provider;
     pc->machine_cert_specs = dc->proxy_machine_cert_specs;
     pc->machine_certified_keys = apr_array_make(p, 3, sizeof(const rustls_certified_key*));
     return pc;
 }
 
+tls_conf_proxy_t *tls_conf_proxy_get(
+    apr_pool_t *p, tls_conf_dir_t *dc, tls_conf_global_t *gc, server_rec *s)
+{
+    tls_conf_proxy_t *pc;
+    int i;
+
+    for (i = 0; i < gc->proxy_configs->nelts; ++i) {
+        pc = APR_ARRAY_IDX(gc->proxy_configs, i, tls_conf_proxy_t*);
+        if (same_proxy_settings(pc, dc)) {
+            ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s,
+                "%s: sharing proxy_conf defined in %s", s->server_hostname,
+                pc->defined_in->server_hostname);
+            return pc;
+        }
+    }
+    pc = tls_conf_proxy_make(p, dc, gc, s);
+    ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s, "%s: adding proxy_conf to globals",
+        s->server_hostname);
+    APR_ARRAY_PUSH(gc->proxy_configs, tls_conf_proxy_t*) = pc;
+    return pc;
+}
+
 int tls_proxy_section_post_config(
     apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s,
     ap_conf_vector_t *section_config)
@@ -266,11 +354,7 @@ int tls_proxy_section_post_config(
     if (proxy_dc->proxy_enabled && !proxy_dc->proxy_config) {
         /* remember `proxy_dc` for subsequent configuration of outoing TLS setups */
         sc = tls_conf_server_get(s);
-        proxy_dc->proxy_config = tls_conf_proxy_make(p, proxy_dc, sc->global, s);
-        ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s,
-            "%s: adding proxy_conf to globals in proxy_post_config_section",
-            s->server_hostname);
-        APR_ARRAY_PUSH(sc->global->proxy_configs, tls_conf_proxy_t*) = proxy_dc->proxy_config;
+        proxy_dc->proxy_config = tls_conf_proxy_get(p, proxy_dc, sc->global, s);
     }
 cleanup:
     return OK;
@@ -438,6 +522,47 @@ static const char *parse_ciphers(
     return NULL;
 }
 
+static const char *get_crypto_provider(
+    cmd_parms *cmd, tls_conf_global_t *gc, const char *name,
+    const tls_provider_t **pprovider)
+{
+    *pprovider = tls_proto_get_provider(gc->proto, name);
+    if (!*pprovider) {
+        return apr_pstrcat(cmd->pool, cmd->cmd->name, ": crypto provider '", name,
+                           "' is not available, known are: ",
+                           tls_proto_get_provider_names(gc->proto, cmd->pool), NULL);
+    }
+    return NULL;
+}
+
+static const char *tls_conf_set_crypto_provider(
+    cmd_parms *cmd, void *dc, const char *name)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+
+    (void)dc;
+    return get_crypto_provider(cmd, sc->global, name, &sc->crypto_provider);
+}
+
+static const char *tls_conf_set_crypto_benchmark(
+    cmd_parms *cmd, void *dc, const char *v)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int flag;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+    flag = flag_value(v);
+    if (TLS_FLAG_UNSET == flag) {
+        err = flag_err(cmd, v);
+        goto cleanup;
+    }
+    sc->global->crypto_benchmark = flag;
+cleanup:
+    return err;
+}
+
 static const char *tls_conf_set_preferred_ciphers(
     cmd_parms *cmd, void *dc, int argc, char *const argv[])
 {
@@ -589,6 +714,335 @@ cleanup:
     return err;
 }
 
+static const char *tls_conf_set_session_cache_partition(
+    cmd_parms *cmd, void *dc, const char *name, const char *spec)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+
+    (void)dc;
+    err = tls_cache_set_partition(name, spec, sc, cmd->pool);
+    if (err) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name, ": ", err, NULL);
+    }
+    return err;
+}
+
+static const char *tls_conf_set_prewarm(
+    cmd_parms *cmd, void *dc, const char *value)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int n;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    n = atoi(value);
+    if (n < 0 || n > 100 || (n == 0 && strcmp("0", value))) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected a number of handshakes from 0 to 100, not '", value, "'", NULL);
+        goto cleanup;
+    }
+    sc->global->prewarm_handshakes = n;
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_flight_recorder(
+    cmd_parms *cmd, void *dc, const char *size, const char *slow)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    apr_interval_time_t timeout;
+    int n;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    n = atoi(size);
+    if (n < 0 || n > 100000 || (n == 0 && strcmp("0", size))) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected a number of entries from 0 to 100000, not '", size, "'", NULL);
+        goto cleanup;
+    }
+    sc->global->recorder_size = n;
+    if (slow) {
+        /* ap_timeout_parameter_parse() takes "soon" as 0 seconds */
+        if (!apr_isdigit(*slow)
+            || APR_SUCCESS != ap_timeout_parameter_parse(slow, &timeout, "ms")
+            || timeout <= 0) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": invalid duration for slow handshakes '", slow, "'", NULL);
+            goto cleanup;
+        }
+        sc->global->recorder_slow = timeout;
+    }
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_pipeline(
+    cmd_parms *cmd, void *dc, const char *threads, const char *depth)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int n;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    n = atoi(threads);
+    if (n < 0 || n > 1000 || (n == 0 && strcmp("0", threads))) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected a number of threads from 0 to 1000, not '", threads, "'", NULL);
+        goto cleanup;
+    }
+    sc->global->pipeline_threads = n;
+    if (depth) {
+        n = atoi(depth);
+        if (n < 1 || n > 64) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": expected a queue depth from 1 to 64, not '", depth, "'", NULL);
+            goto cleanup;
+        }
+        sc->global->pipeline_depth = n;
+    }
+#if !APR_HAS_THREADS
+    if (sc->global->pipeline_threads > 0) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": not available, the server has no thread support", NULL);
+    }
+#endif
+cleanup:
+    return err;
+}
+
+static const char *buffer_size_parse(const char *s, int *psize, apr_pool_t *p)
+{
+    apr_off_t n;
+    char *end;
+
+    if (APR_SUCCESS != apr_strtoff(&n, s, &end, 10) || n <= 0) goto invalid;
+    switch (apr_tolower(*end)) {
+        case 'k': n *= 1024; ++end; break;
+        case 'm': n *= 1024 * 1024; ++end; break;
+        default: break;
+    }
+    if (*end || n > 64 * 1024 * 1024) goto invalid;
+    *psize = (int)n;
+    return NULL;
+invalid:
+    return apr_pstrcat(p, "invalid buffer size '", s, "'", NULL);
+}
+
+static const char *tls_conf_set_buffer_autotune(
+    cmd_parms *cmd, void *dc, const char *min, const char *max)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int bmin, bmax;
+
+    (void)dc;
+    if (!strcasecmp("off", min) && !max) {
+        sc->buffer_min = sc->buffer_max = 0;
+        goto cleanup;
+    }
+    if (!max) {
+        err = "needs 'off' or a minimum and maximum buffer size";
+        goto cleanup;
+    }
+    if ((err = buffer_size_parse(min, &bmin, cmd->pool))) goto cleanup;
+    if ((err = buffer_size_parse(max, &bmax, cmd->pool))) goto cleanup;
+    if (bmin > bmax) {
+        err = "the minimum buffer size is larger than the maximum";
+        goto cleanup;
+    }
+    sc->buffer_min = bmin;
+    sc->buffer_max = bmax;
+cleanup:
+    if (err) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name, ": ", err, NULL);
+    }
+    return err;
+}
+
+static const char *tls_conf_set_hs_limit(
+    cmd_parms *cmd, void *dc, const char *rate, const char *burst)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int r, b;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    if (!strcasecmp("off", rate) && !burst) {
+        sc->global->hs_limit_rate = sc->global->hs_limit_burst = 0;
+        goto cleanup;
+    }
+    r = atoi(rate);
+    if (r <= 0 || r > 100000) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected 'off' or handshakes per second from 1 to 100000, not '",
+                          rate, "'", NULL);
+        goto cleanup;
+    }
+    b = r;
+    if (burst) {
+        b = atoi(burst);
+        if (b <= 0 || b > 100000) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": expected a burst from 1 to 100000 handshakes, not '",
+                              burst, "'", NULL);
+            goto cleanup;
+        }
+    }
+#if !APR_VERSION_AT_LEAST(1,7,0)
+    err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                      ": needs 64 bit atomics, not supported by your APR", NULL);
+    goto cleanup;
+#endif
+    sc->global->hs_limit_rate = r;
+    sc->global->hs_limit_burst = b;
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_hs_limit_action(
+    cmd_parms *cmd, void *dc, const char *action, const char *wait, const char *waiting)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    apr_interval_time_t timeout = apr_time_from_sec(1);
+    int n = sc->global->hs_limit_max_delayed;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    if (!strcasecmp("reject", action) && !wait) {
+        sc->global->hs_limit_delay = 0;
+    }
+    else if (!strcasecmp("delay", action)) {
+        if (wait && (APR_SUCCESS != ap_timeout_parameter_parse(wait, &timeout, "ms")
+                     || timeout <= 0)) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": invalid maximum delay '", wait, "'", NULL);
+            goto cleanup;
+        }
+        if (waiting) {
+            n = atoi(waiting);
+            if (n <= 0 || n > 10000) {
+                err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                                  ": expected from 1 to 10000 delayed handshakes, not '",
+                                  waiting, "'", NULL);
+                goto cleanup;
+            }
+        }
+        sc->global->hs_limit_delay = timeout;
+        sc->global->hs_limit_max_delayed = n;
+    }
+    else {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected 'reject' or 'delay [max-wait [max-waiting]]', not '",
+                          action, "'", NULL);
+    }
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_hs_limit_prefix(
+    cmd_parms *cmd, void *dc, const char *v4, const char *v6)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int n4, n6;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+
+    n4 = atoi(v4);
+    if (n4 < 0 || n4 > 32 || (n4 == 0 && strcmp("0", v4))) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": expected an IPv4 prefix length from 0 to 32, not '", v4, "'", NULL);
+        goto cleanup;
+    }
+    n6 = sc->global->hs_limit_v6_prefix;
+    if (v6) {
+        n6 = atoi(v6);
+        if (n6 < 0 || n6 > 128 || (n6 == 0 && strcmp("0", v6))) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": expected an IPv6 prefix length from 0 to 128, not '", v6, "'", NULL);
+            goto cleanup;
+        }
+    }
+    sc->global->hs_limit_v4_prefix = n4;
+    sc->global->hs_limit_v6_prefix = n6;
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_hs_limit_allow(
+    cmd_parms *cmd, void *dc, int argc, char *const argv[])
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    apr_ipsubnet_t *subnet;
+    char *addr, *mask;
+    apr_status_t rv;
+    int i;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+    if (!argc) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name, ": needs at least one address", NULL);
+        goto cleanup;
+    }
+    if (!sc->global->hs_limit_allow) {
+        sc->global->hs_limit_allow = apr_array_make(cmd->pool, argc, sizeof(apr_ipsubnet_t*));
+    }
+    for (i = 0; i < argc; ++i) {
+        addr = apr_pstrdup(cmd->temp_pool, argv[i]);
+        mask = strchr(addr, '/');
+        if (mask) *mask++ = '\0';
+        rv = apr_ipsubnet_create(&subnet, addr, mask, cmd->pool);
+        if (APR_SUCCESS != rv) {
+            err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                              ": not a valid address or network '", argv[i], "'", NULL);
+            goto cleanup;
+        }
+        APR_ARRAY_PUSH(sc->global->hs_limit_allow, apr_ipsubnet_t*) = subnet;
+    }
+cleanup:
+    return err;
+}
+
+static const char *tls_conf_set_tcp_stats(
+    cmd_parms *cmd, void *dc, const char *v)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+    const char *err = NULL;
+    int flag;
+
+    (void)dc;
+    if ((err = ap_check_cmd_context(cmd, GLOBAL_ONLY))) goto cleanup;
+    flag = flag_value(v);
+    if (TLS_FLAG_UNSET == flag) {
+        err = flag_err(cmd, v);
+        goto cleanup;
+    }
+#if !APR_VERSION_AT_LEAST(1,7,0)
+    if (TLS_FLAG_TRUE == flag) {
+        err = apr_pstrcat(cmd->pool, cmd->cmd->name,
+                          ": needs 64 bit atomics, not supported by your APR", NULL);
+        goto cleanup;
+    }
+#endif
+    sc->global->tcp_stats = flag;
+cleanup:
+    return err;
+}
+
 static const char *tls_conf_set_proxy_engine(cmd_parms *cmd, void *dir_conf, int flag)
 {
     tls_conf_dir_t *dc = dir_conf;
@@ -632,6 +1086,15 @@ cleanup:
     return err;
 }
 
+static const char *tls_conf_set_proxy_crypto_provider(
+    cmd_parms *cmd, void *dir_conf, const char *name)
+{
+    tls_conf_dir_t *dc = dir_conf;
+    tls_conf_server_t *sc = tls_conf_server_get(cmd->server);
+
+    return get_crypto_provider(cmd, sc->global, name, &dc->proxy_crypto_provider);
+}
+
 static const char *tls_conf_set_proxy_suppressed_ciphers(
     cmd_parms *cmd, void *dir_conf, int argc, char *const argv[])
 {
@@ -742,6 +1205,10 @@ const command_rec tls_conf_cmds[] = {
         "Set the TLS ciphers to prefer when negotiating with a client."),
     AP_INIT_TAKE_ARGV("TLSCiphersSuppress", tls_conf_set_suppressed_ciphers, NULL, RSRC_CONF,
         "Set the TLS ciphers to never use when negotiating with a client."),
+    AP_INIT_TAKE1("TLSCryptoProvider", tls_conf_set_crypto_provider, NULL, RSRC_CONF,
+        "Set the crypto provider of the rustls library to use, e.g. 'aws-lc-rs' or 'ring'."),
+    AP_INIT_TAKE1("TLSCryptoBenchmark", tls_conf_set_crypto_benchmark, NULL, RSRC_CONF,
+        "Set 'on' to measure handshake and encryption speed of each crypto provider at start."),
     AP_INIT_TAKE1("TLSHonorClientOrder", tls_conf_set_honor_client_order, NULL, RSRC_CONF,
         "Set 'on' to have the server honor client preferences in cipher suites, default off."),
     AP_INIT_TAKE1("TLSEngine", tls_conf_add_engine, NULL, RSRC_CONF,
@@ -754,6 +1221,33 @@ const command_rec tls_conf_cmds[] = {
         "Set strictness of client server name (SNI) check against hosts, default on."),
     AP_INIT_TAKE1("TLSSessionCache", tls_conf_set_session_cache, NULL, RSRC_CONF,
         "Set which cache to use for TLS sessions."),
+    AP_INIT_TAKE12("TLSSessionCachePartition", tls_conf_set_session_cache_partition, NULL, RSRC_CONF,
+        "Use a separate TLS session cache, shared by all servers with the same partition name."),
+    AP_INIT_TAKE1("TLSPrewarm", tls_conf_set_prewarm, NULL, RSRC_CONF,
+                  "Number of in-memory handshakes per key to perform when a child starts."),
+    AP_INIT_TAKE12("TLSFlightRecorder", tls_conf_set_flight_recorder, NULL, RSRC_CONF,
+                  "Number of failed or slow handshakes to keep per child and the duration "
+                  "at which a handshake is considered slow."),
+    AP_INIT_TAKE12("TLSPipeline", tls_conf_set_pipeline, NULL, RSRC_CONF,
+                  "Number of threads per child to read and encrypt large files ahead "
+                  "and the number of buffers to queue per connection."),
+    AP_INIT_TAKE12("TLSBufferAutotune", tls_conf_set_buffer_autotune, NULL, RSRC_CONF,
+                  "Adjust the TLS buffers of connections to their TCP state, within a "
+                  "minimum and maximum size, or 'off'."),
+    AP_INIT_TAKE12("TLSHandshakeLimit", tls_conf_set_hs_limit, NULL, RSRC_CONF,
+                  "Number of full handshakes per second and client address prefix, "
+                  "with an optional burst, or 'off'."),
+    AP_INIT_TAKE123("TLSHandshakeLimitAction", tls_conf_set_hs_limit_action, NULL, RSRC_CONF,
+                  "What to do with handshakes over the limit: 'reject' or 'delay' "
+                  "for at most the given duration, with at most the given number "
+                  "of handshakes waiting."),
+    AP_INIT_TAKE12("TLSHandshakeLimitPrefix", tls_conf_set_hs_limit_prefix, NULL, RSRC_CONF,
+                  "Number of leading IPv4 and IPv6 address bits that make a client prefix."),
+    AP_INIT_TAKE_ARGV("TLSHandshakeLimitAllow", tls_conf_set_hs_limit_allow, NULL, RSRC_CONF,
+                  "Client addresses or networks that are not limited."),
+    AP_INIT_TAKE1("TLSTCPStats", tls_conf_set_tcp_stats, NULL, RSRC_CONF,
+                  "Set 'on' to sample the TCP state of connections after the handshake "
+                  "and at close, for variables and per server statistics."),
     AP_INIT_FLAG("TLSProxyEngine", tls_conf_set_proxy_engine, NULL, RSRC_CONF|PROXY_CONF,
         "Enable TLS encryption of outgoing connections in this location/server."),
     AP_INIT_TAKE1("TLSProxyCA", tls_conf_set_proxy_ca, NULL, RSRC_CONF|PROXY_CONF,
@@ -762,6 +1256,8 @@ const command_rec tls_conf_cmds[] = {
         "Set the minimum TLS protocol version to use for proxy connections."),
     AP_INIT_TAKE_ARGV("TLSProxyCiphersPrefer", tls_conf_set_proxy_preferred_ciphers, NULL, RSRC_CONF|PROXY_CONF,
         "Set the TLS ciphers to prefer when negotiating a proxy connection."),
+    AP_INIT_TAKE1("TLSProxyCryptoProvider", tls_conf_set_proxy_crypto_provider, NULL, RSRC_CONF|PROXY_CONF,
+        "Set the crypto provider of the rustls library to use on proxy connections."),
     AP_INIT_TAKE_ARGV("TLSProxyCiphersSuppress", tls_conf_set_proxy_suppressed_ciphers, NULL, RSRC_CONF|PROXY_CONF,
         "Set the TLS ciphers to never use when negotiating a proxy connection."),
 #if TLS_CLIENT_CERTS
@@ -22,9 +22,14 @@
 #define TLS_FLAG_TRUE   (1)
 
 struct tls_proto_conf_t;
+struct tls_provider_t;
 struct tls_cert_reg_t;
 struct tls_cert_root_stores_t;
 struct tls_cert_verifiers_t;
+struct tls_cache_partition_t;
+struct tls_limit_t;
+struct tls_tcpstat_t;
+struct tls_tcpstat_server_t;
 struct ap_socache_instance_t;
 struct ap_socache_provider_t;
 struct apr_global_mutex_t;
@@ -84,6 +89,23 @@ typedef struct {
     const struct ap_socache_provider_t *session_cache_provider; /* provider used for session cache */
     struct ap_socache_instance_t *session_cache; /* session cache instance */
     struct apr_global_mutex_t *session_cache_mutex; /* global mutex for access to session cache */
+    apr_hash_t *session_partitions;   /* tls_cache_partition_t* by name */
+    int prewarm_handshakes;           /* # of loopback handshakes per key at child init */
+    int recorder_size;                /* # of handshakes kept in the flight recorder, 0 disables */
+    apr_interval_time_t recorder_slow; /* successful handshakes taking longer are recorded */
+    int pipeline_threads;             /* max # of helper threads for pipelined sending, 0 disables */
+    int pipeline_depth;               /* max # of TLS buffers queued per pipelined connection */
+    int crypto_benchmark;             /* != 0 iff crypto providers are benchmarked at start */
+    int hs_limit_rate;                /* full handshakes per second and client prefix, 0 disables */
+    int hs_limit_burst;               /* max # of handshakes a client prefix may do at once */
+    int hs_limit_v4_prefix;           /* # of IPv4 address bits that make a client prefix */
+    int hs_limit_v6_prefix;           /* # of IPv6 address bits that make a client prefix */
+    apr_interval_time_t hs_limit_delay; /* max delay of handshakes over the limit, 0 rejects */
+    int hs_limit_max_delayed;         /* max # of handshakes delayed at the same time */
+    apr_array_header_t *hs_limit_allow; /* apr_ipsubnet_t* of clients not limited */
+    struct tls_limit_t *hs_limit;     /* shared handshake limit state or NULL */
+    int tcp_stats;                    /* TLS_FLAG_TRUE iff TCP state of connections is sampled */
+    struct tls_tcpstat_t *tcpstat;    /* shared TCP statistics or NULL */
 
     const rustls_server_config *rustls_hello_config; /* used for initial client hello parsing */
 } tls_conf_global_t;
@@ -102,8 +124,12 @@ typedef struct {
     apr_array_header_t *tls_pref_ciphers;  /* List of apr_uint16_t cipher ids to prefer */
     apr_array_header_t *tls_supp_ciphers;  /* List of apr_uint16_t cipher ids to suppress */
     const apr_array_header_t *ciphersuites;  /* Computed post-config, ordered list of rustls cipher suites */
+    const struct tls_provider_t *crypto_provider; /* the crypto provider to use or NULL for default */
     int honor_client_order;           /* honor client cipher ordering */
     int strict_sni;
+    struct tls_cache_partition_t *session_partition; /* session cache partition or NULL for shared */
+    int buffer_min;                   /* lower bound for autotuned filter buffers, 0 for fixed sizes */
+    int buffer_max;                   /* upper bound for autotuned filter buffers */
 
     const char *client_ca;            /* PEM file with trust anchors for client certs */
     tls_client_auth_t client_auth;    /* how client authentication with certificates is used */
@@ -112,6 +138,7 @@ typedef struct {
     apr_array_header_t *certified_keys; /* rustls_certified_key list configured */
     int base_server;                  /* != 0 iff this is the base server */
     int service_unavailable;          /* TLS not trustworthy configured, return 503s */
+    struct tls_tcpstat_server_t *tcp_stats_slot; /* TCP statistics of this server in the first child or NULL */
 } tls_conf_server_t;
 
 typedef struct {
@@ -121,6 +148,7 @@ typedef struct {
     int proxy_protocol_min;            /* the minimum TLS protocol version to use for proxy connections */
     apr_array_header_t *proxy_pref_ciphers;  /* List of apr_uint16_t cipher ids to prefer */
     apr_array_header_t *proxy_supp_ciphers;  /* List of apr_uint16_t cipher ids to suppress */
+    const struct tls_provider_t *crypto_provider; /* the crypto provider to use or NULL for default */
     apr_array_header_t *machine_cert_specs; /* configured machine certificates specs */
     apr_array_header_t *machine_certified_keys;  /* rustls_certified_key list */
     const rustls_client_config *rustls_config;
@@ -134,6 +162,7 @@ typedef struct {
     int proxy_protocol_min;            /* the minimum TLS protocol version to use for proxy connections */
     apr_array_header_t *proxy_pref_ciphers;  /* List of apr_uint16_t cipher ids to prefer */
     apr_array_header_t *proxy_supp_ciphers;  /* List of apr_uint16_t cipher ids to suppress */
+    const struct tls_provider_t *proxy_crypto_provider; /* the crypto provider or NULL for default */
     apr_array_header_t *proxy_machine_cert_specs; /* configured machine certificates specs */
 
     tls_conf_proxy_t *proxy_config;
@@ -178,6 +207,12 @@ apr_status_t tls_conf_dir_apply_defaults(tls_conf_dir_t *dc, apr_pool_t *p);
 tls_conf_proxy_t *tls_conf_proxy_make(
     apr_pool_t *p, tls_conf_dir_t *dc, tls_conf_global_t *gc, server_rec *s);
 
+/* get the proxy configuration for the directory config in server. Configurations
+ * with the same settings are shared, a new one is made and added to the
+ * globals otherwise. */
+tls_conf_proxy_t *tls_conf_proxy_get(
+    apr_pool_t *p, tls_conf_dir_t *dc, tls_conf_global_t *gc, server_rec *s);
+
 int tls_proxy_section_post_config(
     apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s,
     ap_conf_vector_t *section_config);
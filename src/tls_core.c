@@ -37,6 +37,9 @@
 #include "tls_util.h"
 #include "tls_cache.h"
 #include "tls_var.h"
+#include "tls_recorder.h"
+#include "tls_limit.h"
+#include "tls_tcpstat.h"
 
 
 extern module AP_MODULE_DECLARE_DATA tls_module;
@@ -98,7 +101,7 @@ static apr_status_t tls_core_free(void *data)
 
 static apr_status_t load_certified_keys(
     apr_array_header_t *keys, server_rec *s,
-    apr_array_header_t *cert_specs,
+    apr_array_header_t *cert_specs, const tls_provider_t *provider,
     tls_cert_reg_t *cert_reg)
 {
     apr_status_t rv = APR_SUCCESS;
@@ -109,7 +112,7 @@ static apr_status_t load_certified_keys(
     if (cert_specs && cert_specs->nelts > 0) {
         for (i = 0; i < cert_specs->nelts; ++i) {
             spec = APR_ARRAY_IDX(cert_specs, i, tls_cert_spec_t*);
-            rv = tls_cert_reg_get_certified_key(cert_reg, s, spec, &ckey);
+            rv = tls_cert_reg_get_certified_key(cert_reg, s, spec, provider, &ckey);
             if (APR_SUCCESS != rv) {
                 ap_log_error(APLOG_MARK, APLOG_ERR, rv, s, APLOGNO(10318)
                      "Failed to load certificate %d[cert=%s(%d), key=%s(%d)] for %s",
@@ -137,7 +140,8 @@ static apr_status_t use_local_key(
     memset(&spec, 0, sizeof(spec));
     spec.cert_pem = cert_pem;
     spec.pkey_pem = pkey_pem;
-    rv = tls_cert_load_cert_key(c->pool, &spec, NULL, &ckey);
+    rv = tls_cert_load_cert_key(c->pool, &spec,
+                                tls_conf_server_get(cc->server)->crypto_provider, NULL, &ckey);
     if (APR_SUCCESS != rv) goto cleanup;
 
     cc->local_keys = apr_array_make(c->pool, 2, sizeof(const rustls_certified_key*));
@@ -260,7 +264,7 @@ static apr_status_t get_server_ciphersuites(
 
     if (ciphers) {
         suites = tls_proto_get_rustls_suites(
-            sc->global->proto, ciphers, pool);
+            sc->global->proto, sc->crypto_provider, ciphers, pool);
         if (APLOGtrace2(sc->server)) {
             tls_proto_conf_t *conf = sc->global->proto;
             ap_log_error(APLOG_MARK, APLOG_TRACE2, 0, sc->server,
@@ -400,12 +404,19 @@ static apr_status_t server_conf_setup(
 
     cert_specs = complete_cert_specs(ptemp, sc);
     sc->certified_keys = apr_array_make(p, 3, sizeof(rustls_certified_key *));
-    rv = load_certified_keys(sc->certified_keys, sc->server, cert_specs, gc->cert_reg);
+    rv = load_certified_keys(sc->certified_keys, sc->server, cert_specs,
+                             sc->crypto_provider, gc->cert_reg);
     if (APR_SUCCESS != rv) goto cleanup;
 
     rv = get_server_ciphersuites(&sc->ciphersuites, p, sc);
     if (APR_SUCCESS != rv) goto cleanup;
 
+    if (sc->crypto_provider) {
+        ap_log_error(APLOG_MARK, APLOG_TRACE1, 0, sc->server,
+                     "init server: %s uses crypto provider %s",
+                     sc->server->server_hostname, sc->crypto_provider->name);
+    }
+
     ap_log_error(APLOG_MARK, APLOG_TRACE1, rv, sc->server,
                  "init server: %s with %d certificates loaded",
                  sc->server->server_hostname, sc->certified_keys->nelts);
@@ -424,7 +435,8 @@ static apr_status_t get_proxy_ciphers(const apr_array_header_t **pciphersuites,
     if (APR_SUCCESS != rv) goto cleanup;
 
     if (ciphers) {
-        suites = tls_proto_get_rustls_suites(pc->global->proto, ciphers, pool);
+        suites = tls_proto_get_rustls_suites(
+            pc->global->proto, pc->crypto_provider, ciphers, pool);
         /* this changed the default rustls ciphers, configure it. */
         if (APLOGtrace2(pc->defined_in)) {
             tls_proto_conf_t *conf = pc->global->proto;
@@ -488,7 +500,7 @@ static apr_status_t proxy_conf_setup(
 
 #if TLS_MACHINE_CERTS
     rv = load_certified_keys(pc->machine_certified_keys, pc->defined_in,
-                             pc->machine_cert_specs, gc->cert_reg);
+                             pc->machine_cert_specs, pc->crypto_provider, gc->cert_reg);
     if (APR_SUCCESS != rv) goto cleanup;
 #endif
 
@@ -515,6 +527,13 @@ static const rustls_certified_key *extract_client_hello_values(
         cc->sni_hostname = NULL;
         ap_log_cerror(APLOG_MARK, APLOG_TRACE1, 0, c, "no sni from client");
     }
+    if (tls_recorder_enabled() && hello->signature_schemes.len > 0) {
+        cc->sig_schemes = apr_array_make(c->pool, (int)hello->signature_schemes.len,
+                                         sizeof(apr_uint16_t));
+        for (i = 0; i < hello->signature_schemes.len; ++i) {
+            APR_ARRAY_PUSH(cc->sig_schemes, apr_uint16_t) = hello->signature_schemes.data[i];
+        }
+    }
     if (APLOGctrace4(c) && hello->signature_schemes.len > 0) {
         for (i = 0; i < hello->signature_schemes.len; ++i) {
             n = hello->signature_schemes.data[i];
@@ -596,6 +615,12 @@ static apr_status_t init_incoming(apr_pool_t *p, apr_pool_t *ptemp, server_rec *
     rv = tls_cache_post_config(p, ptemp, base_server);
     if (APR_SUCCESS != rv) goto cleanup;
 
+    rv = tls_limit_post_config(p, ptemp, base_server);
+    if (APR_SUCCESS != rv) goto cleanup;
+
+    rv = tls_tcpstat_post_config(p, ptemp, base_server);
+    if (APR_SUCCESS != rv) goto cleanup;
+
     rv = setup_hello_config(p, base_server, gc);
     if (APR_SUCCESS != rv) goto cleanup;
 
@@ -644,10 +669,7 @@ static apr_status_t init_outgoing(apr_pool_t *p, apr_pool_t *ptemp, server_rec *
         rv = tls_conf_dir_apply_defaults(dc, p);
         if (APR_SUCCESS != rv) goto cleanup;
         if (dc->proxy_enabled != TLS_FLAG_TRUE) continue;
-        dc->proxy_config = tls_conf_proxy_make(p, dc, gc, s);
-        ap_log_error(APLOG_MARK, APLOG_TRACE3, 0, s, "%s: adding proxy_conf to globals",
-            s->server_hostname);
-        APR_ARRAY_PUSH(gc->proxy_configs, tls_conf_proxy_t*) = dc->proxy_config;
+        dc->proxy_config = tls_conf_proxy_get(p, dc, gc, s);
     }
     /* Now gc->proxy_configs contains all configurations we need to possibly
      * act on for outgoing connections. */
@@ -761,7 +783,6 @@ static apr_status_t init_outgoing_connection(conn_rec *c)
 {
     tls_conf_conn_t *cc = tls_conf_conn_get(c);
     tls_conf_proxy_t *pc;
-    rustls_crypto_provider_builder *custom_provider_builder = NULL;
     const rustls_crypto_provider *custom_provider = NULL;
     const apr_array_header_t *ciphersuites = NULL;
     apr_array_header_t *tls_versions = NULL;
@@ -791,19 +812,13 @@ static apr_status_t init_outgoing_connection(conn_rec *c)
         tls_versions = tls_proto_create_versions_plus(
             pc->global->proto, (apr_uint16_t)pc->proxy_protocol_min, c->pool);
     }
+    else if (pc->crypto_provider) {
+        tls_versions = tls_proto_create_versions_plus(pc->global->proto, 0, c->pool);
+    }
 
-    if (ciphersuites && ciphersuites->nelts > 0
+    if (((ciphersuites && ciphersuites->nelts > 0) || pc->crypto_provider)
         && tls_versions && tls_versions->nelts >= 0) {
-        rr = rustls_crypto_provider_builder_new_from_default(&custom_provider_builder);
-        if (RUSTLS_RESULT_OK != rr) goto cleanup;
-
-        rr = rustls_crypto_provider_builder_set_cipher_suites(
-                custom_provider_builder,
-                (const struct rustls_supported_ciphersuite *const *)ciphersuites->elts,
-                (size_t)ciphersuites->nelts);
-        if (RUSTLS_RESULT_OK != rr) goto cleanup;
-
-        rr = rustls_crypto_provider_builder_build(custom_provider_builder, &custom_provider);
+        rr = tls_proto_build_crypto_provider(pc->crypto_provider, ciphersuites, &custom_provider);
         if (RUSTLS_RESULT_OK != rr) goto cleanup;
 
         rr = rustls_client_config_builder_new_custom(
@@ -899,7 +914,6 @@ static apr_status_t init_outgoing_connection(conn_rec *c)
     rustls_connection_set_userdata(cc->rustls_connection, c);
 
 cleanup:
-    if (custom_provider_builder != NULL) rustls_crypto_provider_builder_free(custom_provider_builder);
     if (custom_provider != NULL) rustls_crypto_provider_free(custom_provider);
     if (verifier_builder != NULL) rustls_web_pki_server_cert_verifier_builder_free(verifier_builder);
     if (builder != NULL) rustls_client_config_builder_free(builder);
@@ -1079,7 +1093,6 @@ static apr_status_t build_server_connection(rustls_connection **pconnection,
 {
     tls_conf_conn_t *cc = tls_conf_conn_get(c);
     tls_conf_server_t *sc;
-    rustls_crypto_provider_builder *custom_provider_builder = NULL;
     const rustls_crypto_provider *custom_provider = NULL;
     const apr_array_header_t *tls_versions = NULL;
     rustls_server_config_builder *builder = NULL;
@@ -1112,23 +1125,15 @@ static apr_status_t build_server_connection(rustls_connection **pconnection,
             rv = APR_ENOTIMPL; goto cleanup;
         }
     }
-    else if (sc->ciphersuites && sc->ciphersuites->nelts > 0) {
+    else if ((sc->ciphersuites && sc->ciphersuites->nelts > 0) || sc->crypto_provider) {
         /* FIXME: rustls-ffi current has not way to make a builder with ALL_PROTOCOL_VERSIONS */
         tls_versions = tls_proto_create_versions_plus(sc->global->proto, 0, c->pool);
     }
 
-    if (sc->ciphersuites && sc->ciphersuites->nelts > 0
+    if (((sc->ciphersuites && sc->ciphersuites->nelts > 0) || sc->crypto_provider)
         && tls_versions && tls_versions->nelts >= 0) {
-        rr = rustls_crypto_provider_builder_new_from_default(&custom_provider_builder);
-        if (RUSTLS_RESULT_OK != rr) goto cleanup;
-
-        rr = rustls_crypto_provider_builder_set_cipher_suites(
-                custom_provider_builder,
-                (const struct rustls_supported_ciphersuite *const *)sc->ciphersuites->elts,
-                (size_t)sc->ciphersuites->nelts);
-        if (RUSTLS_RESULT_OK != rr) goto cleanup;
-
-        rr = rustls_crypto_provider_builder_build(custom_provider_builder, &custom_provider);
+        rr = tls_proto_build_crypto_provider(sc->crypto_provider, sc->ciphersuites,
+                                             &custom_provider);
         if (RUSTLS_RESULT_OK != rr) goto cleanup;
 
         rr = rustls_server_config_builder_new_custom(
@@ -1186,7 +1191,6 @@ static apr_status_t build_server_connection(rustls_connection **pconnection,
     rustls_connection_set_userdata(rconnection, c);
 
 cleanup:
-    if (custom_provider_builder != NULL) rustls_crypto_provider_builder_free(custom_provider_builder);
     if (custom_provider != NULL) rustls_crypto_provider_free(custom_provider);
     if (rr != RUSTLS_RESULT_OK) {
         const char *err_descr = NULL;
@@ -1228,6 +1232,11 @@ apr_status_t tls_core_conn_seen_client_hello(conn_rec *c)
     sc = tls_conf_server_get(cc->server);
     if (!cc->client_hello_seen) goto cleanup;
 
+    /* rustls does not tell us if the client offers a session to resume,
+     * so every hello takes a token. It is returned after a resumption. */
+    rv = tls_limit_handshake_start(c);
+    if (APR_SUCCESS != rv) goto cleanup;
+
     if (cc->sni_hostname) {
         if (ap_vhost_iterate_given_conn(c, find_vhost, (void*)cc->sni_hostname)) {
             ap_log_cerror(APLOG_MARK, APLOG_DEBUG, rv, c, APLOGNO(10337)
@@ -1307,6 +1316,8 @@ apr_status_t tls_core_conn_post_handshake(conn_rec *c)
         cc->tls_cipher_id, c->pool);
     ap_log_cerror(APLOG_MARK, APLOG_TRACE1, 0, c, "post_handshake %s: %s [%s]",
         cc->server->server_hostname, cc->tls_protocol_name, cc->tls_cipher_name);
+    tls_limit_handshake_done(c);
+    tls_tcpstat_handshake_done(c);
 
     cert = rustls_connection_get_peer_certificate(cc->rustls_connection, 0);
     if (cert) {
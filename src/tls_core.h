@@ -31,6 +31,7 @@ typedef enum {
 #define TLS_CONN_ST_IS_ENABLED(cc)  (cc && cc->state >= TLS_CONN_ST_CLIENT_HELLO)
 
 struct tls_filter_ctx_t;
+struct tls_tcp_info_t;
 
 /* The modules configuration for a connection. Created at connection
  * start and mutable during the lifetime of the connection.
@@ -57,9 +58,12 @@ typedef struct {
     apr_array_header_t *peer_certs;   /* handshaked peer ceritificates or NULL */
     const char *sni_hostname;         /* the SNI value from the client hello, or NULL */
     const apr_array_header_t *alpn;   /* the protocols proposed via ALPN by the client */
+    apr_array_header_t *sig_schemes;  /* apr_uint16_t signature schemes of the client, if recorded */
     const char *application_protocol;    /* the ALPN selected protocol or NULL */
 
     int session_id_cache_hit;         /* if a submitted session id was found in our cache */
+    int hs_limit_charged;             /* != 0 iff the handshake took a TLSHandshakeLimit token */
+    struct tls_tcp_info_t *tcp_info;  /* TCP state sampled after the handshake/at close or NULL */
 
     apr_uint16_t tls_protocol_id;      /* the TLS version negotiated */
     const char *tls_protocol_name;     /* the name of the TLS version negotiated */
@@ -72,6 +76,8 @@ typedef struct {
     rustls_result last_error;
     const char *last_error_descr;
 
+    apr_time_t handshake_start;       /* when the handshake started or 0 */
+
 } tls_conf_conn_t;
 
 /* Get the connection specific module configuration. */
@@ -16,6 +16,11 @@
 #include <assert.h>
 #include <apr_lib.h>
 #include <apr_strings.h>
+#include <apr_atomic.h>
+#if APR_HAS_THREADS
+#include <apr_queue.h>
+#include <apr_thread_pool.h>
+#endif
 
 #include <httpd.h>
 #include <http_connection.h>
@@ -31,6 +36,7 @@
 #include "tls_core.h"
 #include "tls_filter.h"
 #include "tls_util.h"
+#include "tls_recorder.h"
 
 
 extern module AP_MODULE_DECLARE_DATA tls_module;
@@ -160,11 +166,63 @@ cleanup:
     return rv;
 }
 
+/* Retune the buffer sizes after this much output. */
+#define TLS_TUNE_INTERVAL       (1024 * 1024)
+
+static apr_size_t tune_clamp(tls_filter_ctx_t *fctx, apr_size_t n, apr_size_t min)
+{
+    if (n < fctx->tune_min) n = fctx->tune_min;
+    if (n > fctx->tune_max) n = fctx->tune_max;
+    return (n < min)? min : n;
+}
+
+/**
+ * Adjust the amount of data we keep in rustls and our brigades to the
+ * TCP state of the connection, within the bounds configured for its server.
+ * What the network can have in flight towards the client is its congestion
+ * window. A long, fast path has a large one and we like to have enough data
+ * ready to fill it. A short one does not benefit from more than a few records.
+ * When the kernel knows the delivery rate, what it delivers in one round trip
+ * is the bandwidth-delay product, which the window may not have reached yet.
+ */
+static void filter_autotune(tls_filter_ctx_t *fctx)
+{
+    tls_tcp_info_t info;
+    apr_size_t bdp;
+    apr_uint64_t rate_bdp = 0;
+
+    fctx->fout_bytes_since_tune = 0;
+    if (!fctx->tune_max) return;
+    if (APR_SUCCESS != tls_util_tcp_info_get(fctx->c, &info) || !info.snd_cwnd) return;
+
+    bdp = (apr_size_t)info.snd_cwnd * info.snd_mss;
+    if (info.delivery_rate && info.rtt) {
+        rate_bdp = info.delivery_rate * info.rtt / (apr_uint64_t)APR_USEC_PER_SEC;
+        if (rate_bdp > fctx->tune_max) rate_bdp = fctx->tune_max;
+        if (rate_bdp > bdp) bdp = (apr_size_t)rate_bdp;
+    }
+    fctx->fout_max_in_rustls = tune_clamp(fctx, bdp, TLS_PREF_PLAIN_CHUNK_SIZE);
+    fctx->fout_max_in_rustls -= fctx->fout_max_in_rustls % TLS_PREF_PLAIN_CHUNK_SIZE;
+    fctx->fout_auto_flush_size = tune_clamp(fctx, bdp, TLS_REC_MAX_SIZE);
+    fctx->fin_max_in_rustls = tune_clamp(fctx, info.rcv_space, TLS_REC_MAX_SIZE);
+    ap_log_cerror(APLOG_MARK, APLOG_TRACE2, 0, fctx->c,
+                  "autotune: rtt=%uus cwnd=%u mss=%u rcv_space=%u rate_bdp=%ld -> "
+                  "fin_max=%ld fout_max=%ld flush=%ld", info.rtt, info.snd_cwnd,
+                  info.snd_mss, info.rcv_space, (long)rate_bdp, (long)fctx->fin_max_in_rustls,
+                  (long)fctx->fout_max_in_rustls, (long)fctx->fout_auto_flush_size);
+}
+
 static apr_status_t fout_pass_tls_to_net(tls_filter_ctx_t *fctx)
 {
     apr_status_t rv = APR_SUCCESS;
 
     if (!APR_BRIGADE_EMPTY(fctx->fout_tls_bb)) {
+        if (fctx->tune_max) {
+            fctx->fout_bytes_since_tune += fctx->fout_bytes_in_tls_bb;
+            if (fctx->fout_bytes_since_tune >= TLS_TUNE_INTERVAL) filter_autotune(fctx);
+        }
+        ap_log_cerror(APLOG_MARK, APLOG_TRACE3, 0, fctx->c,
+                      "fout_pass_tls_to_net: %ld bytes", (long)fctx->fout_bytes_in_tls_bb);
         rv = ap_pass_brigade(fctx->fout_ctx->next, fctx->fout_tls_bb);
         if (APR_SUCCESS == rv && fctx->c->aborted) {
             rv = APR_ECONNRESET;
@@ -323,6 +381,7 @@ static apr_status_t progress_tls_atleast_to(tls_filter_ctx_t *fctx, tls_conn_sta
 
     if (state > TLS_CONN_ST_CLIENT_HELLO
         && TLS_CONN_ST_CLIENT_HELLO == fctx->cc->state) {
+        if (tls_recorder_enabled()) fctx->cc->handshake_start = apr_time_now();
         rv = tls_core_conn_init(fctx->c);
         if (APR_SUCCESS != rv) goto cleanup;
 
@@ -343,6 +402,13 @@ static apr_status_t progress_tls_atleast_to(tls_filter_ctx_t *fctx, tls_conn_sta
         rv = tls_core_conn_post_handshake(fctx->c);
         if (APR_SUCCESS != rv) goto cleanup;
         fctx->cc->state = TLS_CONN_ST_TRAFFIC;
+        if (!fctx->cc->outgoing) {
+            tls_conf_server_t *sc = tls_conf_server_get(fctx->cc->server);
+            fctx->tune_min = (apr_size_t)sc->buffer_min;
+            fctx->tune_max = (apr_size_t)sc->buffer_max;
+            filter_autotune(fctx);
+        }
+        tls_recorder_handshake_done(fctx->c, APR_SUCCESS);
     }
 
     if (state < fctx->cc->state) {
@@ -351,6 +417,7 @@ static apr_status_t progress_tls_atleast_to(tls_filter_ctx_t *fctx, tls_conn_sta
 
 cleanup:
     if (APR_SUCCESS != rv) {
+        tls_recorder_handshake_done(fctx->c, rv);
         filter_abort(fctx); /* does change the state itself */
     }
     return rv;
@@ -385,7 +452,7 @@ static apr_status_t filter_conn_input(
     apr_status_t rv = APR_SUCCESS;
     apr_off_t passed = 0, nlen;
     rustls_result rr = RUSTLS_RESULT_OK;
-    apr_size_t in_buf_len;
+    apr_size_t in_buf_len = TLS_PREF_PLAIN_CHUNK_SIZE;
     char *in_buf = NULL;
 
     fctx->fin_block = block;
@@ -426,8 +493,12 @@ static apr_status_t filter_conn_input(
         apr_bucket *b;
 
         if (fctx->fin_bytes_in_rustls > 0) {
-            in_buf_len = APR_BUCKET_BUFF_SIZE;
-            in_buf = ap_calloc(in_buf_len, sizeof(char));
+            /* Let rustls decrypt a complete record into a bucket buffer which
+             * we hand on as is. The buffer does not need zeroing and, if
+             * nothing was decrypted, we keep it for the next round. */
+            if (!in_buf) {
+                in_buf = apr_bucket_alloc(in_buf_len, fctx->c->bucket_alloc);
+            }
             rr = rustls_connection_read(fctx->cc->rustls_connection,
                 (unsigned char*)in_buf, in_buf_len, &rlen);
             if (rr == RUSTLS_RESULT_PLAINTEXT_EMPTY) {
@@ -438,13 +509,10 @@ static apr_status_t filter_conn_input(
             ap_log_cerror(APLOG_MARK, APLOG_TRACE2, rv, fctx->c,
                          "tls_filter_conn_input: got %ld plain bytes from rustls", (long)rlen);
             if (rlen > 0) {
-                b = apr_bucket_heap_create(in_buf, rlen, free, fctx->c->bucket_alloc);
+                b = apr_bucket_heap_create(in_buf, rlen, apr_bucket_free, fctx->c->bucket_alloc);
                 APR_BRIGADE_INSERT_TAIL(fctx->fin_plain_bb, b);
+                in_buf = NULL;
             }
-            else {
-                free(in_buf);
-            }
-            in_buf = NULL;
         }
         if (rlen == 0) {
             /* that did not produce anything either. try getting more
@@ -485,7 +553,7 @@ static apr_status_t filter_conn_input(
     fout_pass_all_to_net(fctx, 0);
 
 cleanup:
-    if (NULL != in_buf) free(in_buf);
+    if (NULL != in_buf) apr_bucket_free(in_buf);
 
     if (APLOGctrace3(fctx->c)) {
         tls_util_bb_log(fctx->c, APLOG_TRACE3, "tls_input, fctx->fin_plain_bb", fctx->fin_plain_bb);
@@ -549,18 +617,30 @@ static rustls_io_result tls_write_vectored_callback(
 {
     tls_filter_ctx_t *fctx = userdata;
     const struct iovec *iov = (const struct iovec*)riov;
-    apr_status_t rv;
+    apr_status_t rv = APR_SUCCESS;
     size_t i, n = 0;
     apr_bucket *b;
 
-    for (i = 0; i < count; ++i, ++iov) {
-        b = apr_bucket_transient_create((const char*)iov->iov_base, iov->iov_len, fctx->fout_tls_bb->bucket_alloc);
-        APR_BRIGADE_INSERT_TAIL(fctx->fout_tls_bb, b);
-        n += iov->iov_len;
+    for (i = 0; i < count; ++i) n += iov[i].iov_len;
+    if ((apr_off_t)n + fctx->fout_bytes_in_tls_bb < (apr_off_t)fctx->fout_auto_flush_size) {
+        /* collect small amounts. The slices are rustls' buffers, so copy them. */
+        for (i = 0; i < count && APR_SUCCESS == rv; ++i, ++iov) {
+            rv = apr_brigade_write(fctx->fout_tls_bb, NULL, NULL,
+                                   (const char*)iov->iov_base, iov->iov_len);
+        }
+        if (APR_SUCCESS != rv) goto cleanup;
+        fctx->fout_bytes_in_tls_bb += (apr_off_t)n;
+    }
+    else {
+        for (i = 0; i < count; ++i, ++iov) {
+            b = apr_bucket_transient_create((const char*)iov->iov_base, iov->iov_len, fctx->fout_tls_bb->bucket_alloc);
+            APR_BRIGADE_INSERT_TAIL(fctx->fout_tls_bb, b);
+        }
+        fctx->fout_bytes_in_tls_bb += (apr_off_t)n;
+        rv = fout_pass_tls_to_net(fctx);
     }
-    fctx->fout_bytes_in_tls_bb += (apr_off_t)n;
-    rv = fout_pass_tls_to_net(fctx);
     *out_n = n;
+cleanup:
     ap_log_error(APLOG_MARK, APLOG_TRACE5, rv, fctx->cc->server,
         "tls_write_vectored_callback: %ld bytes in %d slices", (long)n, (int)count);
     return APR_TO_OS_ERROR(rv);
@@ -602,10 +682,10 @@ static apr_status_t fout_pass_rustls_to_tls(tls_filter_ctx_t *fctx)
                 }
             }
             while (rustls_connection_wants_write(fctx->cc->rustls_connection));
-            ap_log_cerror(APLOG_MARK, APLOG_TRACE3, rv, fctx->c,
-                "fout_pass_rustls_to_tls, %ld bytes ready for network", (long)fctx->fout_bytes_in_tls_bb);
-            fctx->fout_bytes_in_rustls = 0;
         }
+        ap_log_cerror(APLOG_MARK, APLOG_TRACE3, rv, fctx->c,
+            "fout_pass_rustls_to_tls, %ld bytes ready for network", (long)fctx->fout_bytes_in_tls_bb);
+        fctx->fout_bytes_in_rustls = 0;
     }
 cleanup:
     return rv;
@@ -735,13 +815,253 @@ cleanup:
     return rv;
 }
 
+#define TLS_FILE_CHUNK_SIZE  4 * TLS_PREF_PLAIN_CHUNK_SIZE
+
+#if APR_HAS_THREADS
+/*
+ * Pipelined sending of large files.
+ *
+ * For a large file bucket, a helper thread reads the file chunk-wise,
+ * encrypts it via the connection's rustls_connection and queues the TLS
+ * data, while the worker thread writes queued data to the network. The
+ * worker does not touch the rustls_connection until the helper is done,
+ * so each is only ever used by one thread at a time.
+ *
+ * The queue is a FIFO with a single producer and consumer, which keeps the
+ * TLS data in order. Its depth limits the memory used per connection.
+ */
+#define TLS_PIPE_MIN_SIZE       (1024 * 1024)
+#define TLS_PIPE_BUF_SIZE       (TLS_FILE_CHUNK_SIZE + 4 * TLS_REC_EXTRA)
+
+static apr_thread_pool_t *pipe_threads; /* per child, NULL when not configured */
+static int pipe_depth;
+static apr_uint32_t pipe_max;           /* # of helper threads in the pool */
+static volatile apr_uint32_t pipe_busy; /* # of helpers reserved by connections */
+
+/**
+ * Reserve a helper thread for a pipelined send. When all helpers are busy,
+ * we rather encrypt in the worker than queue behind other connections.
+ * @return != 0 if a helper was reserved, release it via pipe_helper_release().
+ */
+static int pipe_helper_reserve(void)
+{
+    if (apr_atomic_inc32(&pipe_busy) < pipe_max) return 1;
+    apr_atomic_dec32(&pipe_busy);
+    return 0;
+}
+
+static void pipe_helper_release(void)
+{
+    apr_atomic_dec32(&pipe_busy);
+}
+
+typedef struct {
+    char *data;                       /* malloc'ed TLS data, owned by the bucket later */
+    apr_size_t len;
+} tls_pipe_buf_t;
+
+typedef struct {
+    rustls_connection *rconnection;   /* used by the helper until it pushes `eos` */
+    apr_file_t *fd;
+    apr_off_t offset;
+    apr_off_t remain;
+    char *plain;                      /* buffer for file chunks */
+    tls_pipe_buf_t *out;              /* buffer being filled with TLS data or NULL */
+    apr_queue_t *queue;               /* tls_pipe_buf_t* ready for the network */
+    volatile apr_uint32_t aborted;    /* set when the worker no longer writes */
+    apr_status_t rv;
+    rustls_result rr;
+    tls_pipe_buf_t eos;               /* pushed last by the helper */
+} tls_pipe_job_t;
+
+static void pipe_buf_free(tls_pipe_buf_t *buf)
+{
+    if (buf) {
+        free(buf->data);
+        free(buf);
+    }
+}
+
+static apr_status_t pipe_push(tls_pipe_job_t *job)
+{
+    apr_status_t rv = APR_SUCCESS;
+
+    if (job->out && job->out->len) {
+        do {
+            rv = apr_queue_push(job->queue, job->out);
+        } while (APR_STATUS_IS_EINTR(rv));
+        if (APR_SUCCESS == rv) job->out = NULL;
+    }
+    return rv;
+}
+
+static rustls_io_result pipe_write_callback(
+    void *userdata, const unsigned char *buf, size_t n, size_t *out_n)
+{
+    tls_pipe_job_t *job = userdata;
+    apr_status_t rv = APR_SUCCESS;
+    size_t len;
+
+    if (!job->out) {
+        job->out = calloc(1, sizeof(*job->out));
+        if (job->out) job->out->data = malloc(TLS_PIPE_BUF_SIZE);
+        if (!job->out || !job->out->data) {
+            pipe_buf_free(job->out);
+            job->out = NULL;
+            return APR_TO_OS_ERROR(APR_ENOMEM);
+        }
+    }
+    len = TLS_PIPE_BUF_SIZE - job->out->len;
+    if (len > n) len = n;
+    memcpy(job->out->data + job->out->len, buf, len);
+    job->out->len += len;
+    *out_n = len;
+    if (job->out->len >= TLS_PIPE_BUF_SIZE) {
+        rv = pipe_push(job);
+    }
+    return APR_TO_OS_ERROR(rv);
+}
+
+static void * APR_THREAD_FUNC pipe_run(apr_thread_t *thread, void *data)
+{
+    tls_pipe_job_t *job = data;
+    apr_status_t rv;
+    rustls_result rr = RUSTLS_RESULT_OK;
+    apr_off_t offset = job->offset;
+    apr_size_t dlen, i, written, n;
+    int os_err;
+
+    (void)thread;
+    rv = apr_file_seek(job->fd, APR_SET, &offset);
+    while (APR_SUCCESS == rv && job->remain > 0 && !apr_atomic_read32(&job->aborted)) {
+        dlen = (job->remain > TLS_FILE_CHUNK_SIZE)? TLS_FILE_CHUNK_SIZE : (apr_size_t)job->remain;
+        rv = apr_file_read(job->fd, job->plain, &dlen);
+        if (APR_SUCCESS != rv) goto cleanup;
+        job->remain -= (apr_off_t)dlen;
+
+        for (i = 0; i < dlen; i += written) {
+            rr = rustls_connection_write(job->rconnection,
+                (const unsigned char*)job->plain + i, dlen - i, &written);
+            if (RUSTLS_RESULT_OK != rr) goto cleanup;
+            while (rustls_connection_wants_write(job->rconnection)) {
+                os_err = rustls_connection_write_tls(job->rconnection,
+                    pipe_write_callback, job, &n);
+                if (os_err) {
+                    rv = APR_FROM_OS_ERROR(os_err);
+                    goto cleanup;
+                }
+            }
+            if (!written) {
+                rv = APR_EGENERAL;
+                goto cleanup;
+            }
+        }
+        rv = pipe_push(job);
+    }
+cleanup:
+    /* anything not pushed is not sent on errors */
+    pipe_buf_free(job->out);
+    job->out = NULL;
+    job->rv = rv;
+    job->rr = rr;
+    do {
+        rv = apr_queue_push(job->queue, &job->eos);
+    } while (APR_STATUS_IS_EINTR(rv));
+    return NULL;
+}
+
+/**
+ * Send the file bucket <b>, reading and encrypting it in a helper thread
+ * while we pass the resulting TLS data on to the network. The caller has
+ * reserved a helper, which is released here.
+ */
+static apr_status_t fout_pass_file_pipelined(tls_filter_ctx_t *fctx, apr_bucket *b)
+{
+    apr_bucket_file *f = (apr_bucket_file *)b->data;
+    tls_pipe_job_t *job;
+    tls_pipe_buf_t *buf;
+    apr_pool_t *ptemp = NULL;
+    apr_bucket *tb;
+    void *item;
+    apr_status_t rv, wrv = APR_SUCCESS;
+
+    /* all TLS data from before the file needs to be ahead of it */
+    rv = fout_pass_all_to_tls(fctx);
+    if (APR_SUCCESS != rv) goto cleanup;
+
+    rv = apr_pool_create(&ptemp, fctx->c->pool);
+    if (APR_SUCCESS != rv) goto cleanup;
+    apr_pool_tag(ptemp, "tls_pipe");
+    job = apr_pcalloc(ptemp, sizeof(*job));
+    job->rconnection = fctx->cc->rustls_connection;
+    job->fd = f->fd;
+    job->offset = b->start;
+    job->remain = (apr_off_t)b->length;
+    job->plain = apr_palloc(ptemp, TLS_FILE_CHUNK_SIZE);
+    rv = apr_queue_create(&job->queue, (unsigned int)pipe_depth, ptemp);
+    if (APR_SUCCESS != rv) goto cleanup;
+
+    rv = apr_thread_pool_push(pipe_threads, pipe_run, job,
+                              APR_THREAD_TASK_PRIORITY_NORMAL, fctx);
+    if (APR_SUCCESS != rv) goto cleanup;
+
+    ap_log_cerror(APLOG_MARK, APLOG_TRACE2, 0, fctx->c,
+                  "fout_pass_file_pipelined: %ld bytes", (long)b->length);
+    /* Until the helper pushes `eos`, it owns the rustls_connection. We need to
+     * consume everything up to it, even when writes fail. */
+    while (1) {
+        rv = apr_queue_pop(job->queue, &item);
+        if (APR_STATUS_IS_EINTR(rv)) continue;
+        if (APR_SUCCESS != rv) {
+            /* We can no longer follow the helper. Stop it and wait until it
+             * has let go of the rustls_connection. What it encrypted is lost,
+             * so the connection cannot continue. */
+            ap_log_cerror(APLOG_MARK, APLOG_ERR, rv, fctx->c, APLOGNO(10372)
+                          "fout_pass_file_pipelined: unable to take data from the helper");
+            apr_atomic_set32(&job->aborted, 1);
+            apr_queue_terminate(job->queue);
+            apr_thread_pool_tasks_cancel(pipe_threads, fctx);
+            fctx->c->aborted = 1;
+            goto cleanup;
+        }
+        if (item == &job->eos) break;
+        buf = item;
+        if (APR_SUCCESS == wrv) {
+            tb = apr_bucket_heap_create(buf->data, buf->len, free, fctx->c->bucket_alloc);
+            APR_BRIGADE_INSERT_TAIL(fctx->fout_tls_bb, tb);
+            fctx->fout_bytes_in_tls_bb += (apr_off_t)buf->len;
+            buf->data = NULL;
+            if (fctx->fout_bytes_in_tls_bb >= (apr_off_t)fctx->fout_auto_flush_size) {
+                wrv = fout_pass_tls_to_net(fctx);
+                if (APR_SUCCESS != wrv) apr_atomic_set32(&job->aborted, 1);
+            }
+        }
+        pipe_buf_free(buf);
+    }
+    fctx->fout_bytes_in_rustls = 0;
+
+    rv = (APR_SUCCESS != wrv)? wrv : job->rv;
+    if (RUSTLS_RESULT_OK != job->rr) {
+        const char *err_descr = "";
+        rv = tls_core_error(fctx->c, job->rr, &err_descr);
+        ap_log_cerror(APLOG_MARK, APLOG_DEBUG, rv, fctx->c, APLOGNO(10373)
+                     "fout_pass_file_pipelined: [%d] %s", (int)job->rr, err_descr);
+    }
+    if (APR_SUCCESS == rv) apr_bucket_delete(b);
+
+cleanup:
+    if (ptemp) apr_pool_destroy(ptemp);
+    pipe_helper_release();
+    return rv;
+}
+#endif /* APR_HAS_THREADS */
+
 static apr_status_t fout_append_plain(tls_filter_ctx_t *fctx, apr_bucket *b)
 {
     const char *data;
     apr_size_t dlen, buf_remain;
     rustls_result rr = RUSTLS_RESULT_OK;
     apr_status_t rv = APR_SUCCESS;
-    const char *lbuf = NULL;
     int flush = 0;
 
     if (b) {
@@ -788,13 +1108,19 @@ static apr_status_t fout_append_plain(tls_filter_ctx_t *fctx, apr_bucket *b)
         else {
             /* we have a large chunk and our plain buffer is empty, write it
              * directly into rustls. */
-#define TLS_FILE_CHUNK_SIZE  4 * TLS_PREF_PLAIN_CHUNK_SIZE
+#if APR_HAS_THREADS
+            if (pipe_threads && APR_BUCKET_IS_FILE(b) && b->length >= TLS_PIPE_MIN_SIZE
+                && pipe_helper_reserve()) {
+                rv = fout_pass_file_pipelined(fctx, b);
+                if (APR_SUCCESS != rv) goto cleanup;
+                goto maybe_flush;
+            }
+#endif
             if (b->length > TLS_FILE_CHUNK_SIZE) {
                 apr_bucket_split(b, TLS_FILE_CHUNK_SIZE);
             }
 
-            if (APR_BUCKET_IS_FILE(b)
-                && (lbuf = malloc(b->length))) {
+            if (APR_BUCKET_IS_FILE(b)) {
                 /* A file bucket is a most wondrous thing. Since the dawn of time,
                  * it has been subject to many optimizations for efficient handling
                  * of large data in the server:
@@ -816,17 +1142,24 @@ static apr_status_t fout_append_plain(tls_filter_ctx_t *fctx, apr_bucket *b)
                  *
                  * We can read file buckets in large chunks than APR_BUCKET_BUFF_SIZE,
                  * with a bit of knowledge about how they work.
+                 * The chunk is read into a buffer we keep for the connection. Reading
+                 * the bucket instead might mmap it, which does not save the copy into
+                 * rustls and falls back to APR_BUCKET_BUFF_SIZE reads for offsets
+                 * that are not page aligned.
                  */
                 apr_bucket_file *f = (apr_bucket_file *)b->data;
                 apr_file_t *fd = f->fd;
                 apr_off_t offset = b->start;
 
+                if (!fctx->fout_buf_file) {
+                    fctx->fout_buf_file = apr_palloc(fctx->c->pool, TLS_FILE_CHUNK_SIZE);
+                }
                 dlen = b->length;
                 rv = apr_file_seek(fd, APR_SET, &offset);
                 if (APR_SUCCESS != rv) goto cleanup;
-                rv = apr_file_read(fd, (void*)lbuf, &dlen);
+                rv = apr_file_read(fd, fctx->fout_buf_file, &dlen);
                 if (APR_SUCCESS != rv && !APR_STATUS_IS_EOF(rv)) goto cleanup;
-                rv = fout_pass_buf_to_rustls(fctx, lbuf, dlen);
+                rv = fout_pass_buf_to_rustls(fctx, fctx->fout_buf_file, dlen);
                 if (APR_SUCCESS != rv) goto cleanup;
                 apr_bucket_delete(b);
             }
@@ -847,7 +1180,6 @@ maybe_flush:
     }
 
 cleanup:
-    if (lbuf) free((void*)lbuf);
     if (rr != RUSTLS_RESULT_OK) {
         const char *err_descr = "";
         rv = tls_core_error(fctx->c, rr, &err_descr);
@@ -986,6 +1318,29 @@ int tls_filter_pre_conn_init(conn_rec *c)
     return OK;
 }
 
+void tls_filter_init_child(apr_pool_t *p, server_rec *s)
+{
+#if APR_HAS_THREADS
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    apr_status_t rv;
+
+    if (!sc || sc->global->pipeline_threads <= 0) return;
+    rv = apr_thread_pool_create(&pipe_threads, 0,
+                                (apr_size_t)sc->global->pipeline_threads, p);
+    if (APR_SUCCESS != rv) {
+        ap_log_error(APLOG_MARK, APLOG_WARNING, rv, s, APLOGNO(10374)
+                     "unable to create threads for pipelined sending, it is disabled");
+        pipe_threads = NULL;
+        return;
+    }
+    pipe_depth = sc->global->pipeline_depth;
+    pipe_max = (apr_uint32_t)sc->global->pipeline_threads;
+#else
+    (void)p;
+    (void)s;
+#endif
+}
+
 void tls_filter_conn_init(conn_rec *c)
 {
     tls_conf_conn_t *cc = tls_conf_conn_get(c);
@@ -35,6 +35,7 @@ struct tls_filter_ctx_t {
     char *fout_buf_plain;                /* a buffer to collect plain bytes for output */
     apr_size_t fout_buf_plain_len;       /* the amount of bytes in the buffer */
     apr_size_t fout_buf_plain_size;      /* the total size of the buffer */
+    char *fout_buf_file;                 /* buffer for reading file chunks or NULL */
     apr_bucket_brigade *fout_tls_bb;     /* TLS encrypted, outgoing network data */
     apr_off_t fout_bytes_in_rustls;      /* # of output plain bytes in rustls_connection */
     apr_off_t fout_bytes_in_tls_bb;      /* # of output tls bytes in our brigade */
@@ -43,6 +44,10 @@ struct tls_filter_ctx_t {
     apr_size_t fout_max_in_rustls;        /* how much plain bytes we like in rustls */
     apr_size_t fout_max_bucket_size;      /* how large bucket chunks we handle before splitting */
     apr_size_t fout_auto_flush_size;      /* on much outoing TLS data we flush to network */
+
+    apr_size_t tune_min;                  /* lower bound for autotuned sizes, 0 if not tuned */
+    apr_size_t tune_max;                  /* upper bound for autotuned sizes */
+    apr_off_t fout_bytes_since_tune;      /* # of TLS bytes passed to network since last tuning */
 };
 
 /**
@@ -57,6 +62,12 @@ void tls_filter_register(apr_pool_t *pool);
  */
 int tls_filter_pre_conn_init(conn_rec *c);
 
+/**
+ * Initialize the child process, e.g. start the threads for pipelined sending
+ * if `TLSPipeline` is configured.
+ */
+void tls_filter_init_child(apr_pool_t *p, server_rec *s);
+
 /**
  * Initialize the connection for use, perform the TLS handshake.
  *
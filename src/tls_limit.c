@@ -0,0 +1,407 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <assert.h>
+#include <apr_lib.h>
+#include <apr_strings.h>
+#include <apr_network_io.h>
+#include <apr_shm.h>
+#include <apr_atomic.h>
+#include <apr_version.h>
+
+#include <httpd.h>
+#include <http_core.h>
+#include <http_log.h>
+#include <http_protocol.h>
+#include <mod_status.h>
+
+#include <rustls.h>
+
+#include "tls_conf.h"
+#include "tls_core.h"
+#include "tls_limit.h"
+
+
+extern module AP_MODULE_DECLARE_DATA tls_module;
+APLOG_USE_MODULE(tls);
+
+/* Buckets are kept in a fixed table. A client prefix is looked up in
+ * TLS_LIMIT_PROBES consecutive slots from its hash. When it is not found,
+ * the fullest bucket of those slots, the one used least recently, is taken
+ * over and starts full again. Clients cycling through more prefixes than there are slots
+ * therefore get more handshakes than the limit. */
+#define TLS_LIMIT_SLOTS         8192
+#define TLS_LIMIT_PROBES        8
+#define TLS_LIMIT_KEY_LEN       17
+
+/* A slot holds the bucket of a client prefix in two words that are only
+ * changed with atomic operations, so handshakes from different clients
+ * never wait for each other. The bucket is kept as the time its next
+ * handshake is due (the "theoretical arrival time" of the generic cell
+ * rate algorithm): each handshake moves it `1s/rate` ahead, a handshake
+ * may start when it is no more than `burst - 1` of those ahead of now.
+ * A bucket whose time has passed is full. When two processes take over
+ * the same slot at the same time, one of them may charge the other's
+ * bucket once. */
+typedef struct {
+    volatile apr_uint64_t key;        /* fingerprint of the client prefix, 0 if slot is unused */
+    volatile apr_uint64_t tat;        /* when the next handshake is due, in apr_time_t */
+} tls_limit_slot_t;
+
+typedef struct {
+    volatile apr_uint64_t full;       /* handshakes that took a token */
+    volatile apr_uint64_t resumed;    /* tokens returned for resumed sessions */
+    volatile apr_uint64_t delayed;    /* handshakes delayed for a token */
+    volatile apr_uint64_t rejected;   /* handshakes rejected */
+    volatile apr_uint64_t allowed;    /* handshakes from clients in the allow list */
+    volatile apr_uint64_t evicted;    /* buckets, not yet full, dropped for lack of slots */
+} tls_limit_counts_t;
+
+typedef struct {
+    tls_limit_counts_t counts;
+    volatile apr_uint32_t delaying;   /* handshakes being delayed right now */
+    tls_limit_slot_t slots[TLS_LIMIT_SLOTS];
+} tls_limit_data_t;
+
+typedef struct tls_limit_t tls_limit_t;
+struct tls_limit_t {
+    apr_shm_t *shm;
+    tls_limit_data_t *data;
+};
+
+/* TLSHandshakeLimit is refused by the configuration without 64 bit atomics,
+ * the fallbacks are not reached. */
+static void count_inc(volatile apr_uint64_t *counter)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    apr_atomic_inc64(counter);
+#else
+    ++*counter;
+#endif
+}
+
+static void count_dec(volatile apr_uint64_t *counter)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    apr_atomic_dec64(counter);
+#else
+    --*counter;
+#endif
+}
+
+static apr_uint64_t atomic_read(volatile apr_uint64_t *val)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    return apr_atomic_read64(val);
+#else
+    return *val;
+#endif
+}
+
+static void atomic_set(volatile apr_uint64_t *val, apr_uint64_t n)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    apr_atomic_set64(val, n);
+#else
+    *val = n;
+#endif
+}
+
+/* Set `*val` to `n` if it is `cmp`, return the value it had. */
+static apr_uint64_t atomic_cas(volatile apr_uint64_t *val, apr_uint64_t n, apr_uint64_t cmp)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    return apr_atomic_cas64(val, n, cmp);
+#else
+    apr_uint64_t prev = *val;
+    if (prev == cmp) *val = n;
+    return prev;
+#endif
+}
+
+static apr_status_t limit_cleanup(void *data)
+{
+    tls_limit_t *limit = data;
+
+    if (limit->shm) {
+        apr_shm_destroy(limit->shm);
+        limit->shm = NULL;
+        limit->data = NULL;
+    }
+    return APR_SUCCESS;
+}
+
+apr_status_t tls_limit_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec *s)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    tls_conf_global_t *gc = sc->global;
+    tls_limit_t *limit;
+    const char *fname = NULL;
+    apr_status_t rv = APR_SUCCESS;
+
+    (void)ptemp;
+    if (gc->hs_limit_rate <= 0) goto cleanup;
+
+    limit = apr_pcalloc(p, sizeof(*limit));
+    rv = apr_shm_create(&limit->shm, sizeof(tls_limit_data_t), NULL, p);
+    if (APR_ENOTIMPL == rv) {
+        /* no anonymous shared memory on this platform */
+        fname = ap_runtime_dir_relative(p, "mod_tls-hslimit");
+        apr_shm_remove(fname, p);
+        rv = apr_shm_create(&limit->shm, sizeof(tls_limit_data_t), fname, p);
+    }
+    if (APR_SUCCESS != rv) {
+        ap_log_error(APLOG_MARK, APLOG_EMERG, rv, s, APLOGNO(10378)
+                     "error creating shared memory for TLSHandshakeLimit");
+        goto cleanup;
+    }
+    apr_pool_cleanup_register(p, limit, limit_cleanup, apr_pool_cleanup_null);
+    limit->data = apr_shm_baseaddr_get(limit->shm);
+    memset(limit->data, 0, sizeof(*limit->data));
+
+    gc->hs_limit = limit;
+    ap_log_error(APLOG_MARK, APLOG_DEBUG, 0, s, APLOGNO(10380)
+                 "TLSHandshakeLimit of %d/s (burst %d) per client, prefixes /%d and /%d",
+                 gc->hs_limit_rate, gc->hs_limit_burst,
+                 gc->hs_limit_v4_prefix, gc->hs_limit_v6_prefix);
+cleanup:
+    return rv;
+}
+
+/* Get the key of the bucket for the client address. Addresses are masked
+ * to the configured prefix lengths, IPv4 mapped IPv6 addresses count as IPv4.
+ * The key is a 64 bit fingerprint of that, never 0. */
+static apr_uint64_t limit_key(const apr_sockaddr_t *addr, const tls_conf_global_t *gc)
+{
+    const unsigned char *ip = addr->ipaddr_ptr;
+    static const unsigned char v4mapped[12] = { 0,0,0,0,0,0,0,0,0,0,0xff,0xff };
+    unsigned char key[TLS_LIMIT_KEY_LEN];
+    apr_uint64_t hash = APR_UINT64_C(14695981039346656037); /* FNV-1a */
+    int i, len = addr->ipaddr_len, bits = gc->hs_limit_v4_prefix;
+
+    memset(key, 0, TLS_LIMIT_KEY_LEN);
+    if (len > TLS_LIMIT_KEY_LEN - 1) len = TLS_LIMIT_KEY_LEN - 1;
+    if (len == 16 && !memcmp(ip, v4mapped, sizeof(v4mapped))) {
+        ip += 12;
+        len = 4;
+    }
+    if (len == 16) bits = gc->hs_limit_v6_prefix;
+    key[0] = (unsigned char)len;
+    for (i = 0; i < len && bits > 0; ++i, bits -= 8) {
+        key[1+i] = ip[i] & (bits >= 8? 0xff : (unsigned char)(0xff << (8 - bits)));
+    }
+    for (i = 0; i < TLS_LIMIT_KEY_LEN; ++i) {
+        hash = (hash ^ key[i]) * APR_UINT64_C(1099511628211);
+    }
+    return hash? hash : 1;
+}
+
+static tls_limit_slot_t *slot_find(tls_limit_data_t *data, apr_uint64_t key)
+{
+    tls_limit_slot_t *slot;
+    int i;
+
+    for (i = 0; i < TLS_LIMIT_PROBES; ++i) {
+        slot = &data->slots[(key + (apr_uint64_t)i) % TLS_LIMIT_SLOTS];
+        if (atomic_read(&slot->key) == key) return slot;
+    }
+    return NULL;
+}
+
+static tls_limit_slot_t *slot_get(tls_limit_data_t *data, apr_uint64_t key, apr_time_t now)
+{
+    tls_limit_slot_t *slot, *victim;
+    apr_uint64_t victim_key, victim_tat, tat;
+    int i;
+
+    for (;;) {
+        victim = NULL;
+        victim_key = victim_tat = 0;
+        for (i = 0; i < TLS_LIMIT_PROBES; ++i) {
+            slot = &data->slots[(key + (apr_uint64_t)i) % TLS_LIMIT_SLOTS];
+            if (atomic_read(&slot->key) == key) return slot;
+            tat = atomic_read(&slot->tat);
+            if (!victim || tat < victim_tat) {
+                victim = slot;
+                victim_key = atomic_read(&slot->key);
+                victim_tat = tat;
+            }
+        }
+        /* take the slot over, unless someone else just did */
+        if (atomic_cas(&victim->key, key, victim_key) == victim_key) break;
+    }
+    if (victim_key && victim_tat > (apr_uint64_t)now) count_inc(&data->counts.evicted);
+    atomic_set(&victim->tat, 0);
+    return victim;
+}
+
+static int limit_allowed(const tls_conf_global_t *gc, conn_rec *c)
+{
+    int i;
+
+    if (!gc->hs_limit_allow) return 0;
+    for (i = 0; i < gc->hs_limit_allow->nelts; ++i) {
+        if (apr_ipsubnet_test(APR_ARRAY_IDX(gc->hs_limit_allow, i, apr_ipsubnet_t*),
+                              c->client_addr)) return 1;
+    }
+    return 0;
+}
+
+apr_status_t tls_limit_handshake_start(conn_rec *c)
+{
+    tls_conf_conn_t *cc = tls_conf_conn_get(c);
+    tls_conf_server_t *sc = tls_conf_server_get(c->base_server);
+    tls_conf_global_t *gc = sc->global;
+    tls_limit_t *limit = gc->hs_limit;
+    tls_limit_slot_t *slot;
+    apr_time_t now;
+    apr_uint64_t tat, due, interval, tolerance;
+    apr_interval_time_t wait = 0;
+    apr_status_t rv = APR_SUCCESS;
+
+    if (!limit || !limit->data || !c->client_addr) goto cleanup;
+
+    if (limit_allowed(gc, c)) {
+        count_inc(&limit->data->counts.allowed);
+        goto cleanup;
+    }
+    now = apr_time_now();
+    interval = (apr_uint64_t)APR_USEC_PER_SEC / (apr_uint64_t)gc->hs_limit_rate;
+    tolerance = (apr_uint64_t)(gc->hs_limit_burst - 1) * interval;
+    slot = slot_get(limit->data, limit_key(c->client_addr, gc), now);
+    tat = atomic_read(&slot->tat);
+    for (;;) {
+        due = (tat > (apr_uint64_t)now)? tat : (apr_uint64_t)now;
+        wait = 0;
+        if (due > (apr_uint64_t)now + tolerance) {
+            /* the bucket is empty. A delayed handshake reserves the next
+             * token, so the ones arriving after it wait even longer. */
+            wait = (apr_interval_time_t)(due - tolerance - (apr_uint64_t)now);
+            if (gc->hs_limit_delay <= 0 || wait > gc->hs_limit_delay) {
+                rv = APR_EACCES;
+                break;
+            }
+        }
+        if (atomic_cas(&slot->tat, due + interval, tat) == tat) break;
+        tat = atomic_read(&slot->tat);
+    }
+
+    if (APR_SUCCESS == rv && wait > 0) {
+        /* Each delay blocks a worker, so only a few may wait at the same time. */
+        if (apr_atomic_inc32(&limit->data->delaying)
+            >= (apr_uint32_t)gc->hs_limit_max_delayed) {
+            apr_atomic_dec32(&limit->data->delaying);
+            /* give the reserved token back */
+            tat = atomic_read(&slot->tat);
+            while (tat > interval) {
+                apr_uint64_t prev = atomic_cas(&slot->tat, tat - interval, tat);
+                if (prev == tat) break;
+                tat = prev;
+            }
+            rv = APR_EACCES;
+        }
+    }
+
+    if (APR_EACCES == rv) {
+        count_inc(&limit->data->counts.rejected);
+        ap_log_cerror(APLOG_MARK, APLOG_DEBUG, 0, c, APLOGNO(10384)
+                      "TLSHandshakeLimit reached for client %s, rejecting handshake",
+                      c->client_ip);
+        goto cleanup;
+    }
+    count_inc(&limit->data->counts.full);
+    cc->hs_limit_charged = 1;
+    if (wait > 0) {
+        count_inc(&limit->data->counts.delayed);
+        ap_log_cerror(APLOG_MARK, APLOG_TRACE1, 0, c,
+                      "TLSHandshakeLimit reached for client %s, delaying handshake %dms",
+                      c->client_ip, (int)apr_time_as_msec(wait));
+        apr_sleep(wait);
+        apr_atomic_dec32(&limit->data->delaying);
+    }
+cleanup:
+    return rv;
+}
+
+void tls_limit_handshake_done(conn_rec *c)
+{
+    tls_conf_conn_t *cc = tls_conf_conn_get(c);
+    tls_conf_server_t *sc = tls_conf_server_get(c->base_server);
+    tls_conf_global_t *gc = sc->global;
+    tls_limit_t *limit = gc->hs_limit;
+    tls_limit_slot_t *slot;
+    apr_uint64_t tat, prev, interval;
+
+    if (!cc || !cc->hs_limit_charged) return;
+    cc->hs_limit_charged = 0;
+    if (!cc->session_id_cache_hit || !limit || !limit->data) return;
+
+    slot = slot_find(limit->data, limit_key(c->client_addr, gc));
+    if (slot) {
+        /* moving the due time back gives the token back. One that has
+         * passed already is a full bucket. */
+        interval = (apr_uint64_t)APR_USEC_PER_SEC / (apr_uint64_t)gc->hs_limit_rate;
+        tat = atomic_read(&slot->tat);
+        while (tat > (apr_uint64_t)apr_time_now()) {
+            prev = atomic_cas(&slot->tat, tat - interval, tat);
+            if (prev == tat) break;
+            tat = prev;
+        }
+    }
+    count_dec(&limit->data->counts.full);
+    count_inc(&limit->data->counts.resumed);
+}
+
+void tls_limit_status(request_rec *r, int flags)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(r->server);
+    tls_limit_t *limit = sc->global->hs_limit;
+    tls_limit_counts_t counts;
+
+    if (!limit || !limit->data) return;
+    counts.full = atomic_read(&limit->data->counts.full);
+    counts.resumed = atomic_read(&limit->data->counts.resumed);
+    counts.delayed = atomic_read(&limit->data->counts.delayed);
+    counts.rejected = atomic_read(&limit->data->counts.rejected);
+    counts.allowed = atomic_read(&limit->data->counts.allowed);
+    counts.evicted = atomic_read(&limit->data->counts.evicted);
+
+    if (flags & AP_STATUS_SHORT) {
+        ap_rprintf(r, "TLSHandshakesFull: %" APR_UINT64_T_FMT "\n", counts.full);
+        ap_rprintf(r, "TLSHandshakesResumed: %" APR_UINT64_T_FMT "\n", counts.resumed);
+        ap_rprintf(r, "TLSHandshakesDelayed: %" APR_UINT64_T_FMT "\n", counts.delayed);
+        ap_rprintf(r, "TLSHandshakesRejected: %" APR_UINT64_T_FMT "\n", counts.rejected);
+        ap_rprintf(r, "TLSHandshakesAllowListed: %" APR_UINT64_T_FMT "\n", counts.allowed);
+        ap_rprintf(r, "TLSHandshakeLimitEvictions: %" APR_UINT64_T_FMT "\n", counts.evicted);
+    }
+    else {
+        ap_rputs("<hr>\n<h2>TLS Handshake Limit</h2>\n<table>\n", r);
+        ap_rprintf(r, "<tr><td>limit</td><td>%d/s, burst %d</td></tr>\n",
+                   sc->global->hs_limit_rate, sc->global->hs_limit_burst);
+        ap_rprintf(r, "<tr><td>full handshakes</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.full);
+        ap_rprintf(r, "<tr><td>resumed</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.resumed);
+        ap_rprintf(r, "<tr><td>delayed</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.delayed);
+        ap_rprintf(r, "<tr><td>rejected</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.rejected);
+        ap_rprintf(r, "<tr><td>allow listed</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.allowed);
+        ap_rprintf(r, "<tr><td>evicted buckets</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                   counts.evicted);
+        ap_rputs("</table>\n", r);
+    }
+}
@@ -0,0 +1,44 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef tls_limit_h
+#define tls_limit_h
+
+/**
+ * Create the shared memory for `TLSHandshakeLimit`, if configured.
+ */
+apr_status_t tls_limit_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec *s);
+
+/**
+ * A client hello has been seen on the connection and a full handshake
+ * may follow. Take a token from the bucket of the client's address prefix.
+ * If the bucket is empty, the handshake is delayed or rejected as configured.
+ *
+ * @return APR_SUCCESS if the handshake may proceed, APR_EACCES if it is rejected
+ */
+apr_status_t tls_limit_handshake_start(conn_rec *c);
+
+/**
+ * The handshake on the connection is done. If the session was resumed,
+ * return the token taken at the start.
+ */
+void tls_limit_handshake_done(conn_rec *c);
+
+/**
+ * Report the handshake limit counters for mod_status.
+ */
+void tls_limit_status(request_rec *r, int flags);
+
+#endif /* tls_limit_h */
@@ -0,0 +1,592 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <assert.h>
+#include <apr_lib.h>
+#include <apr_strings.h>
+#include <apr_hash.h>
+
+#include <httpd.h>
+#include <http_log.h>
+
+#include <rustls.h>
+
+#include "tls_conf.h"
+#include "tls_filter.h"
+#include "tls_prewarm.h"
+#include "tls_proto.h"
+#include "tls_util.h"
+
+
+extern module AP_MODULE_DECLARE_DATA tls_module;
+APLOG_USE_MODULE(tls);
+
+/* Loopback handshakes need a few flights back and forth. Give up on anything
+ * that does not finish in this many. */
+#define TLS_PREWARM_MAX_FLIGHTS     16
+#define TLS_PREWARM_BUF_SIZE        (4 * TLS_REC_MAX_SIZE)
+/* Upper limit of handshakes a child does on start, no matter how many
+ * distinct key types and settings the servers have. */
+#define TLS_PREWARM_MAX_TOTAL       256
+
+/* What TLSCryptoBenchmark measures for each crypto provider */
+#define TLS_BENCH_HANDSHAKES        100
+#define TLS_BENCH_BULK_SIZE         (64 * 1024 * 1024)
+
+typedef struct {
+    const rustls_certified_key *key;
+    int tls_protocol_min;
+    const apr_array_header_t *ciphersuites;
+    const tls_provider_t *provider;
+    server_rec *server;
+} tls_prewarm_spec_t;
+
+typedef struct {
+    unsigned char *data;
+    apr_size_t len;
+    apr_size_t off;
+} tls_prewarm_buf_t;
+
+static rustls_io_result prewarm_write_cb(
+    void *userdata, const unsigned char *buf, size_t n, size_t *out_n)
+{
+    tls_prewarm_buf_t *b = userdata;
+    size_t len = TLS_PREWARM_BUF_SIZE - b->len;
+
+    if (len > n) len = n;
+    memcpy(b->data + b->len, buf, len);
+    b->len += len;
+    *out_n = len;
+    return 0;
+}
+
+static rustls_io_result prewarm_read_cb(
+    void *userdata, unsigned char *buf, size_t n, size_t *out_n)
+{
+    tls_prewarm_buf_t *b = userdata;
+    size_t len = b->len - b->off;
+
+    if (len > n) len = n;
+    memcpy(buf, b->data + b->off, len);
+    b->off += len;
+    *out_n = len;
+    return 0;
+}
+
+static uint32_t prewarm_verify_server_cert(
+    void *userdata, const rustls_verify_server_cert_params *params)
+{
+    /* we talk to ourself, the key is the one we loaded */
+    (void)userdata;
+    (void)params;
+    return RUSTLS_RESULT_OK;
+}
+
+/* Move everything `from` wants to write into `to` and let it process it. */
+static rustls_result prewarm_transfer(
+    rustls_connection *from, rustls_connection *to, tls_prewarm_buf_t *b)
+{
+    rustls_result rr = RUSTLS_RESULT_OK;
+    size_t n;
+
+    while (rustls_connection_wants_write(from)) {
+        b->len = b->off = 0;
+        while (rustls_connection_wants_write(from) && b->len < TLS_PREWARM_BUF_SIZE) {
+            if (rustls_connection_write_tls(from, prewarm_write_cb, b, &n) || !n) break;
+        }
+        if (!b->len) break;
+        while (b->off < b->len) {
+            if (rustls_connection_read_tls(to, prewarm_read_cb, b, &n) || !n) {
+                rr = RUSTLS_RESULT_IO;
+                goto cleanup;
+            }
+            rr = rustls_connection_process_new_packets(to);
+            if (RUSTLS_RESULT_OK != rr) goto cleanup;
+        }
+    }
+cleanup:
+    return rr;
+}
+
+static rustls_result prewarm_connect(
+    const rustls_server_config *server_config,
+    const rustls_client_config *client_config, tls_prewarm_buf_t *b,
+    rustls_connection **psconn, rustls_connection **pcconn)
+{
+    rustls_connection *sconn = NULL, *cconn = NULL;
+    rustls_result rr;
+    int i;
+
+    rr = rustls_server_connection_new(server_config, &sconn);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    rr = rustls_client_connection_new(client_config, "localhost", &cconn);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+
+    for (i = 0; i < TLS_PREWARM_MAX_FLIGHTS; ++i) {
+        if (!rustls_connection_is_handshaking(sconn)
+            && !rustls_connection_is_handshaking(cconn)) break;
+        rr = prewarm_transfer(cconn, sconn, b);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+        rr = prewarm_transfer(sconn, cconn, b);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    if (rustls_connection_is_handshaking(sconn)
+        || rustls_connection_is_handshaking(cconn)) {
+        rr = RUSTLS_RESULT_HANDSHAKE_NOT_COMPLETE;
+    }
+cleanup:
+    if (RUSTLS_RESULT_OK != rr) {
+        if (cconn) rustls_connection_free(cconn);
+        if (sconn) rustls_connection_free(sconn);
+        sconn = cconn = NULL;
+    }
+    *psconn = sconn;
+    *pcconn = cconn;
+    return rr;
+}
+
+static rustls_result prewarm_handshake(
+    const rustls_server_config *server_config,
+    const rustls_client_config *client_config, tls_prewarm_buf_t *b)
+{
+    rustls_connection *sconn, *cconn;
+    rustls_result rr;
+
+    rr = prewarm_connect(server_config, client_config, b, &sconn, &cconn);
+    if (RUSTLS_RESULT_OK == rr) {
+        rustls_connection_free(cconn);
+        rustls_connection_free(sconn);
+    }
+    return rr;
+}
+
+static rustls_result prewarm_client_config(
+    const tls_provider_t *provider, tls_proto_conf_t *proto,
+    const rustls_client_config **pconfig, apr_pool_t *p)
+{
+    rustls_client_config_builder *builder = NULL;
+    const apr_array_header_t *tls_versions;
+    rustls_result rr = RUSTLS_RESULT_OK;
+
+    *pconfig = NULL;
+    if (provider) {
+        tls_versions = tls_proto_create_versions_plus(proto, 0, p);
+        rr = rustls_client_config_builder_new_custom(
+            provider->provider,
+            (const uint16_t *)tls_versions->elts, (size_t)tls_versions->nelts,
+            &builder);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    else {
+        builder = rustls_client_config_builder_new();
+        if (!builder) {
+            rr = RUSTLS_RESULT_NULL_PARAMETER;
+            goto cleanup;
+        }
+    }
+    rr = rustls_client_config_builder_dangerous_set_certificate_verifier(
+        builder, prewarm_verify_server_cert);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    rustls_client_config_builder_set_enable_sni(builder, false);
+    rr = rustls_client_config_builder_build(builder, pconfig);
+    builder = NULL;
+
+cleanup:
+    if (builder) rustls_client_config_builder_free(builder);
+    return rr;
+}
+
+static rustls_result prewarm_server_config(
+    const tls_prewarm_spec_t *spec, const rustls_server_config **pconfig, apr_pool_t *p)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(spec->server);
+    const rustls_crypto_provider *custom_provider = NULL;
+    const apr_array_header_t *tls_versions = NULL;
+    rustls_server_config_builder *builder = NULL;
+    rustls_result rr = RUSTLS_RESULT_OK;
+
+    *pconfig = NULL;
+    if (spec->tls_protocol_min > 0 || spec->provider
+        || (spec->ciphersuites && spec->ciphersuites->nelts > 0)) {
+        tls_versions = tls_proto_create_versions_plus(
+            sc->global->proto, (apr_uint16_t)spec->tls_protocol_min, p);
+    }
+    if (tls_versions && tls_versions->nelts > 0) {
+        rr = tls_proto_build_crypto_provider(spec->provider, spec->ciphersuites, &custom_provider);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+
+        rr = rustls_server_config_builder_new_custom(
+            custom_provider,
+            (const uint16_t *)tls_versions->elts, (size_t)tls_versions->nelts,
+            &builder);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    else {
+        builder = rustls_server_config_builder_new();
+        if (NULL == builder) {
+            rr = RUSTLS_RESULT_NULL_PARAMETER;
+            goto cleanup;
+        }
+    }
+
+    rr = rustls_server_config_builder_set_certified_keys(builder, &spec->key, 1);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+
+    rr = rustls_server_config_builder_build(builder, pconfig);
+    builder = NULL;
+
+cleanup:
+    if (builder) rustls_server_config_builder_free(builder);
+    if (custom_provider) rustls_crypto_provider_free(custom_provider);
+    return rr;
+}
+
+/* Read the tag and length of the DER element at `*p`, which ends before `end`.
+ * On success, `*p` points to the element's contents of `*plen` bytes. */
+static int der_read(const uint8_t **p, const uint8_t *end, uint8_t *ptag, size_t *plen)
+{
+    const uint8_t *d = *p;
+    size_t len, n;
+
+    if (end - d < 2) return 0;
+    *ptag = *d++;
+    len = *d++;
+    if (len & 0x80) {
+        n = len & 0x7f;
+        if (n == 0 || n > sizeof(size_t) || (size_t)(end - d) < n) return 0;
+        for (len = 0; n > 0; --n) len = (len << 8) | *d++;
+    }
+    if ((size_t)(end - d) < len) return 0;
+    *p = d;
+    *plen = len;
+    return 1;
+}
+
+/* Enter the element at `*p` if it has `tag`, `*pend` is then its end. */
+static int der_enter(const uint8_t **p, const uint8_t **pend, uint8_t tag)
+{
+    uint8_t t;
+    size_t len;
+
+    if (!der_read(p, *pend, &t, &len) || t != tag) return 0;
+    *pend = *p + len;
+    return 1;
+}
+
+static int der_skip(const uint8_t **p, const uint8_t *end)
+{
+    uint8_t t;
+    size_t len;
+
+    if (!der_read(p, end, &t, &len)) return 0;
+    *p += len;
+    return 1;
+}
+
+static int der_is_oid(const uint8_t *oid, size_t oid_len,
+                      const unsigned char *expected, size_t expected_len)
+{
+    return oid_len == expected_len && !memcmp(oid, expected, oid_len);
+}
+
+/* The type of the key, from the algorithm of the SubjectPublicKeyInfo in
+ * its certificate. Keys of the same type run the same code paths, one of
+ * them is enough to warm them. Returns NULL when the type is unknown. */
+static const char *prewarm_key_type(const rustls_certified_key *key)
+{
+    static const unsigned char OID_RSA[] = {
+        0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01 };
+    static const unsigned char OID_EC[] = { 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01 };
+    static const unsigned char OID_P256[] = {
+        0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07 };
+    static const unsigned char OID_P384[] = { 0x2b, 0x81, 0x04, 0x00, 0x22 };
+    static const unsigned char OID_P521[] = { 0x2b, 0x81, 0x04, 0x00, 0x23 };
+    static const unsigned char OID_ED25519[] = { 0x2b, 0x65, 0x70 };
+    const rustls_certificate *cert;
+    const uint8_t *der, *end, *alg, *param;
+    size_t der_len, alg_len, param_len;
+    uint8_t tag;
+    int i;
+
+    cert = rustls_certified_key_get_certificate(key, 0);
+    if (!cert || RUSTLS_RESULT_OK != rustls_certificate_get_der(cert, &der, &der_len)) {
+        return NULL;
+    }
+    end = der + der_len;
+    /* Certificate, then TBSCertificate */
+    if (!der_enter(&der, &end, 0x30) || !der_enter(&der, &end, 0x30)) return NULL;
+    /* optional [0] version */
+    if (der < end && *der == 0xa0 && !der_skip(&der, end)) return NULL;
+    /* serialNumber, signature, issuer, validity, subject */
+    for (i = 0; i < 5; ++i) {
+        if (!der_skip(&der, end)) return NULL;
+    }
+    /* SubjectPublicKeyInfo, then its AlgorithmIdentifier */
+    if (!der_enter(&der, &end, 0x30) || !der_enter(&der, &end, 0x30)) return NULL;
+    if (!der_read(&der, end, &tag, &alg_len) || tag != 0x06) return NULL;
+    alg = der;
+    der += alg_len;
+
+    if (der_is_oid(alg, alg_len, OID_RSA, sizeof(OID_RSA))) return "rsa";
+    if (der_is_oid(alg, alg_len, OID_ED25519, sizeof(OID_ED25519))) return "ed25519";
+    if (der_is_oid(alg, alg_len, OID_EC, sizeof(OID_EC))) {
+        /* the named curve is the parameter */
+        if (!der_read(&der, end, &tag, &param_len) || tag != 0x06) return NULL;
+        param = der;
+        if (der_is_oid(param, param_len, OID_P256, sizeof(OID_P256))) return "ec-p256";
+        if (der_is_oid(param, param_len, OID_P384, sizeof(OID_P384))) return "ec-p384";
+        if (der_is_oid(param, param_len, OID_P521, sizeof(OID_P521))) return "ec-p521";
+    }
+    return NULL;
+}
+
+static void prewarm_add_specs(apr_hash_t *specs, server_rec *s, apr_pool_t *p)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    tls_prewarm_spec_t *spec;
+    const char *id, *key_type;
+    int i, j;
+
+    if (!sc || sc->enabled != TLS_FLAG_TRUE || !sc->certified_keys) return;
+    for (i = 0; i < sc->certified_keys->nelts; ++i) {
+        spec = apr_pcalloc(p, sizeof(*spec));
+        spec->key = APR_ARRAY_IDX(sc->certified_keys, i, const rustls_certified_key*);
+        spec->tls_protocol_min = sc->tls_protocol_min;
+        spec->ciphersuites = sc->ciphersuites;
+        spec->provider = sc->crypto_provider;
+        spec->server = s;
+        /* servers with the same key type and settings need to be warmed only once.
+         * Keys of unknown type are warmed each. */
+        key_type = prewarm_key_type(spec->key);
+        id = apr_psprintf(p, "%s:%d:%pp", key_type? key_type : apr_psprintf(p, "%pp", spec->key),
+                          spec->tls_protocol_min, spec->provider);
+        for (j = 0; spec->ciphersuites && j < spec->ciphersuites->nelts; ++j) {
+            id = apr_psprintf(p, "%s:%pp", id,
+                APR_ARRAY_IDX(spec->ciphersuites, j, const rustls_supported_ciphersuite*));
+        }
+        if (!apr_hash_get(specs, id, APR_HASH_KEY_STRING)) {
+            ap_log_error(APLOG_MARK, APLOG_TRACE1, 0, s, "prewarm key %d of %s, type %s",
+                         i, s->server_hostname, key_type? key_type : "unknown");
+            apr_hash_set(specs, id, APR_HASH_KEY_STRING, spec);
+        }
+    }
+}
+
+void tls_prewarm_child(apr_pool_t *p, server_rec *base_server)
+{
+    tls_conf_server_t *bsc = tls_conf_server_get(base_server);
+    const rustls_client_config *client_config = NULL;
+    const rustls_server_config *server_config = NULL;
+    apr_pool_t *ptemp = NULL;
+    apr_hash_t *specs;
+    apr_hash_index_t *hi;
+    tls_prewarm_buf_t buf;
+    tls_prewarm_spec_t *spec;
+    apr_time_t start;
+    rustls_result rr = RUSTLS_RESULT_OK;
+    int i, count = 0, failed = 0;
+    server_rec *s;
+
+    if (!bsc || bsc->global->prewarm_handshakes <= 0) goto cleanup;
+
+    start = apr_time_now();
+    apr_pool_create(&ptemp, p);
+    apr_pool_tag(ptemp, "tls_prewarm");
+    specs = apr_hash_make(ptemp);
+    for (s = base_server; s; s = s->next) {
+        prewarm_add_specs(specs, s, ptemp);
+    }
+    if (apr_hash_count(specs) == 0) goto cleanup;
+
+    rr = prewarm_client_config(NULL, bsc->global->proto, &client_config, ptemp);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+
+    buf.data = apr_palloc(ptemp, TLS_PREWARM_BUF_SIZE);
+    for (hi = apr_hash_first(ptemp, specs); hi; hi = apr_hash_next(hi)) {
+        if (count >= TLS_PREWARM_MAX_TOTAL) {
+            ap_log_error(APLOG_MARK, APLOG_DEBUG, 0, base_server, APLOGNO(10366)
+                         "prewarm stopped after %d handshakes", count);
+            break;
+        }
+        spec = apr_hash_this_val(hi);
+        rr = prewarm_server_config(spec, &server_config, ptemp);
+        if (RUSTLS_RESULT_OK != rr) {
+            ap_log_error(APLOG_MARK, APLOG_DEBUG, 0, spec->server, APLOGNO(10367)
+                         "prewarm config for %s failed: [%d]",
+                         spec->server->server_hostname, (int)rr);
+            ++failed;
+            continue;
+        }
+        for (i = 0; i < bsc->global->prewarm_handshakes && count < TLS_PREWARM_MAX_TOTAL; ++i) {
+            rr = prewarm_handshake(server_config, client_config, &buf);
+            if (RUSTLS_RESULT_OK != rr) {
+                const char *err_descr = "";
+                apr_status_t rv = tls_util_rustls_error(ptemp, rr, &err_descr);
+                ap_log_error(APLOG_MARK, APLOG_DEBUG, rv, spec->server, APLOGNO(10368)
+                             "prewarm handshake for %s failed: [%d] %s",
+                             spec->server->server_hostname, (int)rr, err_descr);
+                ++failed;
+                break;
+            }
+            ++count;
+        }
+        rustls_server_config_free(server_config);
+        server_config = NULL;
+    }
+    rr = RUSTLS_RESULT_OK;
+
+    ap_log_error(APLOG_MARK, APLOG_INFO, 0, base_server, APLOGNO(10369)
+                 "prewarmed TLS with %d handshakes for %d key type/cipher combinations "
+                 "(%d failed) in %" APR_TIME_T_FMT "ms", count, (int)apr_hash_count(specs),
+                 failed, apr_time_as_msec(apr_time_now() - start));
+
+cleanup:
+    if (RUSTLS_RESULT_OK != rr) {
+        const char *err_descr = "";
+        apr_status_t rv = tls_util_rustls_error(p, rr, &err_descr);
+        ap_log_error(APLOG_MARK, APLOG_WARNING, rv, base_server, APLOGNO(10370)
+                     "TLS prewarming failed: [%d] %s", (int)rr, err_descr);
+    }
+    if (client_config) rustls_client_config_free(client_config);
+    if (ptemp) apr_pool_destroy(ptemp);
+}
+
+/* Send `len` bytes of application data from server to client and
+ * decrypt them there. */
+static rustls_result bench_bulk(
+    rustls_connection *sconn, rustls_connection *cconn, tls_prewarm_buf_t *b,
+    unsigned char *plain, apr_off_t len)
+{
+    rustls_result rr = RUSTLS_RESULT_OK;
+    apr_off_t sent = 0;
+    size_t n;
+
+    while (sent < len) {
+        rr = rustls_connection_write(sconn, plain, TLS_PREF_PLAIN_CHUNK_SIZE, &n);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+        sent += (apr_off_t)n;
+        rr = prewarm_transfer(sconn, cconn, b);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+        do {
+            rr = rustls_connection_read(cconn, plain, TLS_PREF_PLAIN_CHUNK_SIZE, &n);
+        } while (RUSTLS_RESULT_OK == rr && n > 0);
+        if (RUSTLS_RESULT_OK != rr && RUSTLS_RESULT_PLAINTEXT_EMPTY != rr) goto cleanup;
+        rr = RUSTLS_RESULT_OK;
+    }
+cleanup:
+    return rr;
+}
+
+static rustls_result bench_provider(
+    const tls_prewarm_spec_t *spec, tls_proto_conf_t *proto,
+    tls_prewarm_buf_t *b, unsigned char *plain, apr_pool_t *p)
+{
+    const rustls_client_config *client_config = NULL;
+    const rustls_server_config *server_config = NULL;
+    rustls_connection *sconn = NULL, *cconn = NULL;
+    apr_time_t start, hs_duration, bulk_duration;
+    apr_uint16_t cipher;
+    rustls_result rr;
+    int i;
+
+    rr = prewarm_server_config(spec, &server_config, p);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    rr = prewarm_client_config(spec->provider, proto, &client_config, p);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+
+    start = apr_time_now();
+    for (i = 0; i < TLS_BENCH_HANDSHAKES; ++i) {
+        rr = prewarm_handshake(server_config, client_config, b);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    hs_duration = apr_time_now() - start;
+
+    rr = prewarm_connect(server_config, client_config, b, &sconn, &cconn);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    cipher = rustls_connection_get_negotiated_ciphersuite(sconn);
+    start = apr_time_now();
+    rr = bench_bulk(sconn, cconn, b, plain, TLS_BENCH_BULK_SIZE);
+    if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    bulk_duration = apr_time_now() - start;
+
+    ap_log_error(APLOG_MARK, APLOG_NOTICE, 0, spec->server, APLOGNO(10375)
+                 "crypto provider %s: %d handshakes/s with the key of %s, "
+                 "%d MB/s with %s (in memory, client and server)",
+                 spec->provider->name,
+                 (int)(TLS_BENCH_HANDSHAKES * APR_USEC_PER_SEC / (hs_duration? hs_duration : 1)),
+                 spec->server->server_hostname,
+                 (int)((TLS_BENCH_BULK_SIZE / (1024 * 1024)) * APR_USEC_PER_SEC
+                       / (bulk_duration? bulk_duration : 1)),
+                 tls_proto_get_cipher_name(proto, cipher, p));
+
+cleanup:
+    if (cconn) rustls_connection_free(cconn);
+    if (sconn) rustls_connection_free(sconn);
+    if (client_config) rustls_client_config_free(client_config);
+    if (server_config) rustls_server_config_free(server_config);
+    return rr;
+}
+
+void tls_prewarm_benchmark(apr_pool_t *p, server_rec *base_server)
+{
+    tls_conf_server_t *bsc = tls_conf_server_get(base_server);
+    tls_conf_server_t *sc;
+    tls_proto_conf_t *proto;
+    tls_prewarm_spec_t spec;
+    tls_prewarm_buf_t buf;
+    unsigned char *plain;
+    apr_pool_t *ptemp = NULL;
+    rustls_result rr;
+    server_rec *s;
+    int i;
+
+    if (!bsc || !bsc->global->crypto_benchmark) goto cleanup;
+    proto = bsc->global->proto;
+
+    memset(&spec, 0, sizeof(spec));
+    for (s = base_server; s && !spec.key; s = s->next) {
+        sc = tls_conf_server_get(s);
+        if (sc->enabled != TLS_FLAG_TRUE || !sc->certified_keys
+            || sc->certified_keys->nelts <= 0) continue;
+        spec.key = APR_ARRAY_IDX(sc->certified_keys, 0, const rustls_certified_key*);
+        spec.server = s;
+    }
+    if (!spec.key) {
+        ap_log_error(APLOG_MARK, APLOG_NOTICE, 0, base_server, APLOGNO(10376)
+                     "TLSCryptoBenchmark: no server with a certificate to benchmark with");
+        goto cleanup;
+    }
+
+    apr_pool_create(&ptemp, p);
+    apr_pool_tag(ptemp, "tls_benchmark");
+    buf.data = apr_palloc(ptemp, TLS_PREWARM_BUF_SIZE);
+    plain = apr_pcalloc(ptemp, TLS_PREF_PLAIN_CHUNK_SIZE);
+    for (i = 0; i < proto->providers->nelts; ++i) {
+        spec.provider = APR_ARRAY_IDX(proto->providers, i, const tls_provider_t*);
+        /* "default" is one of the others, unless it is all we have */
+        if (proto->providers->nelts > 1 && !strcmp("default", spec.provider->name)) continue;
+        rr = bench_provider(&spec, proto, &buf, plain, ptemp);
+        if (RUSTLS_RESULT_OK != rr) {
+            const char *err_descr = "";
+            apr_status_t rv = tls_util_rustls_error(ptemp, rr, &err_descr);
+            ap_log_error(APLOG_MARK, APLOG_WARNING, rv, base_server, APLOGNO(10377)
+                         "crypto provider %s: benchmark failed: [%d] %s",
+                         spec.provider->name, (int)rr, err_descr);
+        }
+    }
+
+cleanup:
+    if (ptemp) apr_pool_destroy(ptemp);
+}
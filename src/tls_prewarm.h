@@ -0,0 +1,39 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef tls_prewarm_h
+#define tls_prewarm_h
+
+/**
+ * Perform `TLSPrewarm` loopback handshakes in memory for each distinct
+ * combination of certified key and cipher/protocol settings configured.
+ *
+ * This brings code pages, key material and the crypto provider into
+ * a warm state before the child process accepts traffic. Failures are
+ * logged, but do not prevent the child from running.
+ * @param p the child pool
+ * @param s the base server
+ */
+void tls_prewarm_child(apr_pool_t *p, server_rec *s);
+
+/**
+ * If `TLSCryptoBenchmark` is enabled, measure in memory handshakes and
+ * bulk encryption for each crypto provider available and log the results.
+ * @param p a pool for temporary allocations
+ * @param s the base server
+ */
+void tls_prewarm_benchmark(apr_pool_t *p, server_rec *s);
+
+#endif /* tls_prewarm_h */
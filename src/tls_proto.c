@@ -417,6 +417,44 @@ typedef struct {
     const rustls_supported_ciphersuite *rustls_suite;
 } rustls_cipher_t;
 
+static apr_status_t provider_free(void *data)
+{
+    tls_provider_t *provider = data;
+
+    if (provider->provider) {
+        rustls_crypto_provider_free(provider->provider);
+        provider->provider = NULL;
+    }
+    return APR_SUCCESS;
+}
+
+static void add_provider(
+    tls_proto_conf_t *conf, const char *name,
+    const rustls_crypto_provider *rustls_provider, apr_pool_t *pool)
+{
+    tls_provider_t *provider;
+    const rustls_supported_ciphersuite *rustls_suite;
+    rustls_cipher_t *rcipher;
+    size_t i, len;
+
+    if (!rustls_provider) return;
+    provider = apr_pcalloc(pool, sizeof(*provider));
+    provider->name = name;
+    provider->provider = rustls_provider;
+    provider->rustls_ciphers_by_id = apr_hash_make(pool);
+    len = rustls_crypto_provider_ciphersuites_len(rustls_provider);
+    for (i = 0; i < len; ++i) {
+        rustls_suite = rustls_crypto_provider_ciphersuites_get(rustls_provider, i);
+        if (!rustls_suite) continue;
+        rcipher = apr_pcalloc(pool, sizeof(*rcipher));
+        rcipher->id = rustls_supported_ciphersuite_get_suite(rustls_suite);
+        rcipher->rustls_suite = rustls_suite;
+        apr_hash_set(provider->rustls_ciphers_by_id, &rcipher->id, sizeof(apr_uint16_t), rcipher);
+    }
+    apr_pool_cleanup_register(pool, provider, provider_free, apr_pool_cleanup_null);
+    APR_ARRAY_PUSH(conf->providers, tls_provider_t*) = provider;
+}
+
 tls_proto_conf_t *tls_proto_init(apr_pool_t *pool, server_rec *s)
 {
     tls_proto_conf_t *conf;
@@ -457,6 +495,18 @@ tls_proto_conf_t *tls_proto_init(apr_pool_t *pool, server_rec *s)
         apr_hash_set(conf->rustls_ciphers_by_id, &rcipher->id, sizeof(apr_uint16_t), rcipher);
     }
 
+    /* The providers rustls-ffi was built with. rustls.h declares them
+     * only when DEFINE_AWS_LC_RS/DEFINE_RING are set, which configure
+     * does after finding them in the library. */
+    conf->providers = apr_array_make(pool, 3, sizeof(tls_provider_t*));
+    add_provider(conf, "default", rustls_crypto_provider_default(), pool);
+#if defined(DEFINE_AWS_LC_RS)
+    add_provider(conf, "aws-lc-rs", rustls_aws_lc_rs_crypto_provider(), pool);
+#endif
+#if defined(DEFINE_RING)
+    add_provider(conf, "ring", rustls_ring_crypto_provider(), pool);
+#endif
+
     return conf;
 }
 
@@ -582,21 +632,78 @@ const char *tls_proto_get_cipher_name(
     return apr_psprintf(pool, "TLS_CIPHER_0x%04x", id);
 }
 
+const tls_provider_t *tls_proto_get_provider(tls_proto_conf_t *conf, const char *name)
+{
+    const tls_provider_t *provider;
+    int i;
+
+    for (i = 0; i < conf->providers->nelts; ++i) {
+        provider = APR_ARRAY_IDX(conf->providers, i, const tls_provider_t*);
+        if (!apr_strnatcasecmp(name, provider->name)) return provider;
+    }
+    return NULL;
+}
+
+const char *tls_proto_get_provider_names(tls_proto_conf_t *conf, apr_pool_t *pool)
+{
+    apr_array_header_t *names;
+    int i;
+
+    names = apr_array_make(pool, conf->providers->nelts, sizeof(const char*));
+    for (i = 0; i < conf->providers->nelts; ++i) {
+        APR_ARRAY_PUSH(names, const char *) =
+            APR_ARRAY_IDX(conf->providers, i, const tls_provider_t*)->name;
+    }
+    return apr_array_pstrcat(pool, names, ',');
+}
+
 apr_array_header_t *tls_proto_get_rustls_suites(
-    tls_proto_conf_t *conf, const apr_array_header_t *ids, apr_pool_t *pool)
+    tls_proto_conf_t *conf, const tls_provider_t *provider,
+    const apr_array_header_t *ids, apr_pool_t *pool)
 {
     apr_array_header_t *suites;
+    apr_hash_t *rustls_ciphers_by_id;
     rustls_cipher_t *rcipher;
     apr_uint16_t id;
     int i;
 
+    rustls_ciphers_by_id = provider? provider->rustls_ciphers_by_id : conf->rustls_ciphers_by_id;
     suites = apr_array_make(pool, ids->nelts, sizeof(const rustls_supported_ciphersuite*));
     for (i = 0; i < ids->nelts; ++i) {
         id = APR_ARRAY_IDX(ids, i, apr_uint16_t);
-        rcipher = apr_hash_get(conf->rustls_ciphers_by_id, &id, sizeof(apr_uint16_t));
+        rcipher = apr_hash_get(rustls_ciphers_by_id, &id, sizeof(apr_uint16_t));
         if (rcipher) {
             APR_ARRAY_PUSH(suites, const rustls_supported_ciphersuite *) = rcipher->rustls_suite;
         }
     }
     return suites;
 }
+
+rustls_result tls_proto_build_crypto_provider(
+    const tls_provider_t *provider, const apr_array_header_t *suites,
+    const rustls_crypto_provider **pprovider)
+{
+    rustls_crypto_provider_builder *builder = NULL;
+    rustls_result rr = RUSTLS_RESULT_OK;
+
+    *pprovider = NULL;
+    if (provider) {
+        builder = rustls_crypto_provider_builder_new_with_base(provider->provider);
+    }
+    else {
+        rr = rustls_crypto_provider_builder_new_from_default(&builder);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    if (suites && suites->nelts > 0) {
+        rr = rustls_crypto_provider_builder_set_cipher_suites(
+                builder,
+                (const struct rustls_supported_ciphersuite *const *)suites->elts,
+                (size_t)suites->nelts);
+        if (RUSTLS_RESULT_OK != rr) goto cleanup;
+    }
+    rr = rustls_crypto_provider_builder_build(builder, pprovider);
+
+cleanup:
+    if (builder) rustls_crypto_provider_builder_free(builder);
+    return rr;
+}
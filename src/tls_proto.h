@@ -32,6 +32,17 @@ typedef struct {
     const char *alias;    /* Optional, commonly known alternate name */
 } tls_cipher_t;
 
+/**
+ * A crypto provider available in the rustls library, by the name
+ * used in configurations.
+ */
+typedef struct tls_provider_t tls_provider_t;
+struct tls_provider_t {
+    const char *name;     /* name of the provider, e.g. "ring" */
+    const struct rustls_crypto_provider *provider; /* the rustls provider */
+    apr_hash_t *rustls_ciphers_by_id; /* hash by id of its rustls_supported_ciphersuite* */
+};
+
 /**
  * TLS protocol related definitions constructed
  * by querying crustls lib.
@@ -43,6 +54,7 @@ struct tls_proto_conf_t {
     apr_hash_t *known_ciphers_by_id; /* hash by id of known tls_cipher_t* */
     apr_hash_t *rustls_ciphers_by_id; /* hash by id of rustls rustls_supported_ciphersuite* */
     apr_array_header_t *supported_cipher_ids; /* cipher ids (apr_uint16_t) supported by rustls */
+    apr_array_header_t *providers; /* tls_provider_t* of the crypto providers available */
     const rustls_root_cert_store *native_roots;
 };
 
@@ -113,12 +125,35 @@ const char *tls_proto_get_cipher_name(
 const char *tls_proto_get_cipher_names(
     tls_proto_conf_t *conf, const apr_array_header_t *ciphers, apr_pool_t *pool);
 
+/**
+ * Get a crypto provider by name. "default" is the provider rustls uses
+ * when none is selected.
+ * @return the provider or NULL if no such provider is available
+ */
+const tls_provider_t *tls_proto_get_provider(tls_proto_conf_t *conf, const char *name);
+
+/**
+ * Get the names of all crypto providers available, separated by ','.
+ */
+const char *tls_proto_get_provider_names(tls_proto_conf_t *conf, apr_pool_t *pool);
+
 /**
  * Convert an array of TLS cipher 16bit identifiers into the `rustls_supported_ciphersuite`
  * instances that can be passed to crustls in session configurations.
  * Any cipher identifier not supported by rustls we be silently omitted.
+ * @param provider the crypto provider the suites are for, NULL for the default one
  */
 apr_array_header_t *tls_proto_get_rustls_suites(
-    tls_proto_conf_t *conf, const apr_array_header_t *ids, apr_pool_t *pool);
+    tls_proto_conf_t *conf, const tls_provider_t *provider,
+    const apr_array_header_t *ids, apr_pool_t *pool);
+
+/**
+ * Build a rustls crypto provider based on `provider` (NULL for the default one),
+ * limited to the given `rustls_supported_ciphersuite`s, unless `suites` is NULL
+ * or empty. The caller owns the provider returned and must free it.
+ */
+rustls_result tls_proto_build_crypto_provider(
+    const tls_provider_t *provider, const apr_array_header_t *suites,
+    const rustls_crypto_provider **pprovider);
 
 #endif /* tls_proto_h */
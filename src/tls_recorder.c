@@ -0,0 +1,229 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <assert.h>
+#include <apr_lib.h>
+#include <apr_strings.h>
+#include <apr_thread_mutex.h>
+#include <unistd.h>
+
+#include <httpd.h>
+#include <http_core.h>
+#include <http_log.h>
+#include <http_protocol.h>
+#include <http_request.h>
+
+#include <rustls.h>
+
+#include "tls_cert.h"
+#include "tls_conf.h"
+#include "tls_core.h"
+#include "tls_proto.h"
+#include "tls_recorder.h"
+#include "tls_util.h"
+
+
+extern module AP_MODULE_DECLARE_DATA tls_module;
+APLOG_USE_MODULE(tls);
+
+#define TLS_RECORDER_MAX_SIG_SCHEMES    16
+
+/* A compact, fixed size summary of a handshake. All strings are
+ * truncated copies, so an entry never references connection memory. */
+typedef struct {
+    apr_time_t start;
+    apr_interval_time_t duration;
+    apr_status_t rv;
+    rustls_result rr;
+    int outgoing;
+    apr_uint16_t tls_protocol_id;
+    apr_uint16_t tls_cipher_id;
+    apr_size_t sig_schemes_len;
+    apr_uint16_t sig_schemes[TLS_RECORDER_MAX_SIG_SCHEMES];
+    char peer[64];
+    char sni[128];
+    char alpn[128];
+    char server[128];
+    char key[128];
+} tls_recorder_entry_t;
+
+typedef struct {
+    tls_recorder_entry_t *entries;
+    int size;                         /* # of entries in the ring */
+    int next;                         /* index of the next entry to write */
+    int count;                        /* # of entries written in total */
+    apr_interval_time_t slow;         /* handshakes taking longer are recorded */
+    tls_conf_global_t *global;
+#if APR_HAS_THREADS
+    apr_thread_mutex_t *mutex;
+#endif
+} tls_recorder_t;
+
+/* Per child process, set up in child_init and never freed. */
+static tls_recorder_t *recorder;
+
+void tls_recorder_init_child(apr_pool_t *p, server_rec *s)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    tls_recorder_t *rec;
+
+    if (!sc || sc->global->recorder_size <= 0) return;
+
+    rec = apr_pcalloc(p, sizeof(*rec));
+    rec->size = sc->global->recorder_size;
+    rec->slow = sc->global->recorder_slow;
+    rec->global = sc->global;
+    rec->entries = apr_pcalloc(p, (apr_size_t)rec->size * sizeof(tls_recorder_entry_t));
+#if APR_HAS_THREADS
+    if (APR_SUCCESS != apr_thread_mutex_create(&rec->mutex, APR_THREAD_MUTEX_DEFAULT, p)) {
+        ap_log_error(APLOG_MARK, APLOG_WARNING, 0, s, APLOGNO(10371)
+                     "unable to create flight recorder mutex, recording is disabled");
+        return;
+    }
+#endif
+    recorder = rec;
+}
+
+int tls_recorder_enabled(void)
+{
+    return recorder != NULL;
+}
+
+static void recorder_lock(tls_recorder_t *rec)
+{
+#if APR_HAS_THREADS
+    apr_thread_mutex_lock(rec->mutex);
+#else
+    (void)rec;
+#endif
+}
+
+static void recorder_unlock(tls_recorder_t *rec)
+{
+#if APR_HAS_THREADS
+    apr_thread_mutex_unlock(rec->mutex);
+#else
+    (void)rec;
+#endif
+}
+
+void tls_recorder_handshake_done(conn_rec *c, apr_status_t rv)
+{
+    tls_conf_conn_t *cc = tls_conf_conn_get(c);
+    tls_recorder_entry_t *e;
+    apr_interval_time_t duration;
+    const char *s;
+    apr_size_t len;
+    int i;
+
+    if (!recorder || !cc || !cc->handshake_start) return;
+    duration = apr_time_now() - cc->handshake_start;
+    if (APR_SUCCESS == rv && duration < recorder->slow) goto cleanup;
+
+    recorder_lock(recorder);
+    e = &recorder->entries[recorder->next];
+    recorder->next = (recorder->next + 1) % recorder->size;
+    ++recorder->count;
+
+    memset(e, 0, sizeof(*e));
+    e->start = cc->handshake_start;
+    e->duration = duration;
+    e->rv = rv;
+    e->rr = cc->last_error;
+    e->outgoing = cc->outgoing;
+    e->tls_protocol_id = cc->tls_protocol_id;
+    e->tls_cipher_id = cc->tls_cipher_id;
+    apr_cpystrn(e->peer, c->client_ip? c->client_ip : "-", sizeof(e->peer));
+    apr_cpystrn(e->sni, cc->sni_hostname? cc->sni_hostname : "-", sizeof(e->sni));
+    apr_cpystrn(e->server, cc->server->server_hostname?
+                cc->server->server_hostname : "-", sizeof(e->server));
+    s = cc->key? tls_cert_reg_get_id(recorder->global->cert_reg, cc->key) : NULL;
+    apr_cpystrn(e->key, s? s : "-", sizeof(e->key));
+    for (i = 0, len = 0; cc->alpn && i < cc->alpn->nelts; ++i) {
+        s = APR_ARRAY_IDX(cc->alpn, i, const char*);
+        if (len + strlen(s) + 2 > sizeof(e->alpn)) break;
+        if (len) e->alpn[len++] = ',';
+        apr_cpystrn(e->alpn + len, s, sizeof(e->alpn) - len);
+        len += strlen(s);
+    }
+    if (!len) apr_cpystrn(e->alpn, "-", sizeof(e->alpn));
+    if (cc->sig_schemes) {
+        e->sig_schemes_len = (apr_size_t)cc->sig_schemes->nelts;
+        if (e->sig_schemes_len > TLS_RECORDER_MAX_SIG_SCHEMES) {
+            e->sig_schemes_len = TLS_RECORDER_MAX_SIG_SCHEMES;
+        }
+        memcpy(e->sig_schemes, cc->sig_schemes->elts,
+               e->sig_schemes_len * sizeof(apr_uint16_t));
+    }
+    recorder_unlock(recorder);
+
+cleanup:
+    /* record a handshake only once */
+    cc->handshake_start = 0;
+}
+
+static void recorder_print(request_rec *r, const tls_recorder_entry_t *e)
+{
+    char tstr[APR_RFC822_DATE_LEN];
+    const char *err_descr = "";
+    apr_size_t i;
+
+    apr_rfc822_date(tstr, e->start);
+    if (e->rr != RUSTLS_RESULT_OK) {
+        tls_util_rustls_error(r->pool, e->rr, &err_descr);
+    }
+    ap_rprintf(r, "%s [%s] %s %ldms status=%d rustls=%d%s%s%s "
+               "sni=%s alpn=%s server=%s key=%s version=%04x cipher=%04x sigschemes=",
+               tstr, e->peer, e->outgoing? "out" : "in",
+               (long)apr_time_as_msec(e->duration), e->rv, (int)e->rr,
+               *err_descr? " (" : "", err_descr, *err_descr? ")" : "",
+               e->sni, e->alpn, e->server, e->key,
+               (int)e->tls_protocol_id, (int)e->tls_cipher_id);
+    for (i = 0; i < e->sig_schemes_len; ++i) {
+        ap_rprintf(r, "%s%04x", i? "," : "", (int)e->sig_schemes[i]);
+    }
+    ap_rputs(e->sig_schemes_len? "\n" : "-\n", r);
+}
+
+int tls_recorder_handler(request_rec *r)
+{
+    tls_recorder_entry_t *entries;
+    int i, n, first;
+
+    if (strcmp(r->handler, TLS_RECORDER_HANDLER)) return DECLINED;
+    if (r->method_number != M_GET) return DECLINED;
+
+    ap_set_content_type(r, "text/plain; charset=us-ascii");
+    if (r->header_only) return OK;
+    if (!recorder) {
+        ap_rputs("flight recorder not enabled, see 'TLSFlightRecorder'\n", r);
+        return OK;
+    }
+
+    /* copy the ring, so we do not hold the lock while writing */
+    entries = apr_palloc(r->pool, (apr_size_t)recorder->size * sizeof(tls_recorder_entry_t));
+    recorder_lock(recorder);
+    memcpy(entries, recorder->entries, (apr_size_t)recorder->size * sizeof(tls_recorder_entry_t));
+    n = (recorder->count < recorder->size)? recorder->count : recorder->size;
+    first = recorder->next;
+    ap_rprintf(r, "# pid %" APR_PID_T_FMT ", %d handshakes recorded, %d shown\n",
+               getpid(), recorder->count, n);
+    recorder_unlock(recorder);
+
+    for (i = 1; i <= n; ++i) {
+        recorder_print(r, &entries[(first - i + recorder->size) % recorder->size]);
+    }
+    return OK;
+}
@@ -0,0 +1,51 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef tls_recorder_h
+#define tls_recorder_h
+
+#define TLS_RECORDER_HANDLER        "tls-flight-recorder"
+
+/**
+ * Set up the flight recorder for this child process, if one has been
+ * configured via `TLSFlightRecorder`.
+ * @param p the child pool
+ * @param s the base server
+ */
+void tls_recorder_init_child(apr_pool_t *p, server_rec *s);
+
+/**
+ * Return != 0 iff the flight recorder is active in this child process.
+ */
+int tls_recorder_enabled(void);
+
+/**
+ * The handshake on the connection has ended, either successfully or
+ * with status `rv`. If it failed or took longer than the configured
+ * threshold, a summary is recorded. Does nothing if no handshake
+ * start has been noted in `tls_conf_conn_t` or the recorder is
+ * not enabled.
+ * @param c the connection
+ * @param rv the outcome of the handshake
+ */
+void tls_recorder_handshake_done(conn_rec *c, apr_status_t rv);
+
+/**
+ * Handler writing the recorded handshakes of the serving child process
+ * as plain text, newest first. Handles `SetHandler tls-flight-recorder`.
+ */
+int tls_recorder_handler(request_rec *r);
+
+#endif /* tls_recorder_h */
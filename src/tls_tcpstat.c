@@ -0,0 +1,274 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <assert.h>
+#include <apr_lib.h>
+#include <apr_strings.h>
+#include <apr_shm.h>
+#include <apr_atomic.h>
+#include <apr_version.h>
+
+#include <httpd.h>
+#include <http_core.h>
+#include <http_log.h>
+#include <http_main.h>
+#include <http_protocol.h>
+#include <ap_mpm.h>
+#include <scoreboard.h>
+#include <mod_status.h>
+
+#include <rustls.h>
+
+#include "tls_conf.h"
+#include "tls_core.h"
+#include "tls_util.h"
+#include "tls_tcpstat.h"
+
+
+extern module AP_MODULE_DECLARE_DATA tls_module;
+APLOG_USE_MODULE(tls);
+
+/* The TCP state of connections at their close, summed up per server.
+ * Each child process has its own row of these, so its threads only need
+ * atomic adds and no lock is shared between processes. */
+typedef struct tls_tcpstat_server_t tls_tcpstat_server_t;
+struct tls_tcpstat_server_t {
+    volatile apr_uint64_t conns;      /* # of connections sampled */
+    volatile apr_uint64_t rtt_sum;    /* sum of smoothed round trip times in microseconds */
+    volatile apr_uint64_t rttvar_sum; /* sum of round trip time variances in microseconds */
+    volatile apr_uint32_t rtt_max;    /* largest round trip time seen */
+    volatile apr_uint64_t retrans;    /* # of retransmitted segments */
+    volatile apr_uint64_t retrans_conns; /* # of connections with retransmits */
+    volatile apr_uint64_t rate_sum;   /* sum of delivery rates in bytes/s */
+    volatile apr_uint64_t rate_conns; /* # of connections with a delivery rate */
+};
+
+typedef struct tls_tcpstat_t tls_tcpstat_t;
+struct tls_tcpstat_t {
+    apr_shm_t *shm;
+    tls_tcpstat_server_t *servers;    /* nchildren rows of nservers each */
+    int nservers;
+    int nchildren;
+};
+
+static void count_add(volatile apr_uint64_t *counter, apr_uint64_t n)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    apr_atomic_add64(counter, n);
+#else
+    /* not reached, TLSTCPStats is refused without 64 bit atomics */
+    *counter += n;
+#endif
+}
+
+static apr_uint64_t count_get(volatile apr_uint64_t *counter)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+    return apr_atomic_read64(counter);
+#else
+    return *counter;
+#endif
+}
+
+static apr_status_t tcpstat_cleanup(void *data)
+{
+    tls_tcpstat_t *stats = data;
+
+    if (stats->shm) {
+        apr_shm_destroy(stats->shm);
+        stats->shm = NULL;
+        stats->servers = NULL;
+    }
+    return APR_SUCCESS;
+}
+
+apr_status_t tls_tcpstat_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec *s)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(s);
+    tls_conf_global_t *gc = sc->global;
+    tls_tcpstat_t *stats;
+    server_rec *ts;
+    apr_size_t size;
+    const char *fname;
+    apr_status_t rv = APR_SUCCESS;
+    int i;
+
+    (void)ptemp;
+    if (gc->tcp_stats != TLS_FLAG_TRUE) goto cleanup;
+
+    stats = apr_pcalloc(p, sizeof(*stats));
+    for (ts = s; ts; ts = ts->next) {
+        if (tls_conf_server_get(ts)->enabled == TLS_FLAG_TRUE) ++stats->nservers;
+    }
+    if (!stats->nservers) goto cleanup;
+    ap_mpm_query(AP_MPMQ_HARD_LIMIT_DAEMONS, &stats->nchildren);
+    if (stats->nchildren <= 0) stats->nchildren = 1;
+
+    size = (apr_size_t)stats->nchildren * (apr_size_t)stats->nservers
+           * sizeof(tls_tcpstat_server_t);
+    rv = apr_shm_create(&stats->shm, size, NULL, p);
+    if (APR_ENOTIMPL == rv) {
+        /* no anonymous shared memory on this platform */
+        fname = ap_runtime_dir_relative(p, "mod_tls-tcpstats");
+        apr_shm_remove(fname, p);
+        rv = apr_shm_create(&stats->shm, size, fname, p);
+    }
+    if (APR_SUCCESS != rv) {
+        ap_log_error(APLOG_MARK, APLOG_EMERG, rv, s, APLOGNO(10385)
+                     "error creating shared memory for TLSTCPStats");
+        goto cleanup;
+    }
+    apr_pool_cleanup_register(p, stats, tcpstat_cleanup, apr_pool_cleanup_null);
+    stats->servers = apr_shm_baseaddr_get(stats->shm);
+    memset(stats->servers, 0, size);
+
+    /* a server's slot in the row of the first child */
+    for (i = 0, ts = s; ts; ts = ts->next) {
+        tls_conf_server_t *tsc = tls_conf_server_get(ts);
+        if (tsc->enabled == TLS_FLAG_TRUE) tsc->tcp_stats_slot = &stats->servers[i++];
+    }
+    gc->tcpstat = stats;
+cleanup:
+    return rv;
+}
+
+void tls_tcpstat_handshake_done(conn_rec *c)
+{
+    tls_conf_conn_t *cc = tls_conf_conn_get(c);
+    tls_conf_server_t *sc;
+    tls_tcp_info_t *info;
+
+    if (!cc || cc->outgoing) return;
+    sc = tls_conf_server_get(cc->server);
+    if (!sc->global->tcpstat) return;
+
+    info = apr_pcalloc(c->pool, sizeof(*info));
+    if (APR_SUCCESS != tls_util_tcp_info_get(c, info)) return;
+    cc->tcp_info = info;
+}
+
+int tls_tcpstat_pre_close(conn_rec *c)
+{
+    tls_conf_conn_t *cc = tls_conf_conn_get(c);
+    tls_conf_server_t *sc;
+    tls_tcpstat_t *stats;
+    tls_tcpstat_server_t *slot;
+    ap_sb_handle_t *sbh = c->sbh;
+    tls_tcp_info_t info;
+    apr_uint32_t max;
+
+    if (c->master || !cc || !cc->tcp_info || !sbh) goto cleanup;
+    sc = tls_conf_server_get(cc->server);
+    stats = sc->global->tcpstat;
+    if (!stats || !sc->tcp_stats_slot) goto cleanup;
+    if (sbh->child_num < 0 || sbh->child_num >= stats->nchildren) goto cleanup;
+    if (APR_SUCCESS != tls_util_tcp_info_get(c, &info)) goto cleanup;
+
+    ap_log_cerror(APLOG_MARK, APLOG_TRACE1, 0, c,
+                  "tcp stats at close: rtt=%uus rttvar=%uus cwnd=%u retrans=%u "
+                  "delivery_rate=%" APR_UINT64_T_FMT "B/s",
+                  info.rtt, info.rttvar, info.snd_cwnd, info.total_retrans,
+                  info.delivery_rate);
+    /* The variables keep the sample from the handshake, this one is only
+     * for the statistics. */
+    slot = sc->tcp_stats_slot + sbh->child_num * stats->nservers;
+    count_add(&slot->conns, 1);
+    count_add(&slot->rtt_sum, info.rtt);
+    count_add(&slot->rttvar_sum, info.rttvar);
+    max = apr_atomic_read32(&slot->rtt_max);
+    while (info.rtt > max) {
+        apr_uint32_t prev = apr_atomic_cas32(&slot->rtt_max, info.rtt, max);
+        if (prev == max) break;
+        max = prev;
+    }
+    if (info.total_retrans) {
+        count_add(&slot->retrans, info.total_retrans);
+        count_add(&slot->retrans_conns, 1);
+    }
+    if (info.delivery_rate) {
+        count_add(&slot->rate_sum, info.delivery_rate);
+        count_add(&slot->rate_conns, 1);
+    }
+cleanup:
+    return OK;
+}
+
+void tls_tcpstat_status(request_rec *r, int flags)
+{
+    tls_conf_server_t *sc = tls_conf_server_get(r->server);
+    tls_tcpstat_t *stats = sc->global->tcpstat;
+    tls_tcpstat_server_t *counts;
+    server_rec *s;
+    const char *name;
+    apr_uint64_t rtt, rttvar, rate;
+    apr_uint32_t max;
+    int child, i;
+
+    if (!stats || !stats->servers) return;
+    /* sum up the rows of all children */
+    counts = apr_pcalloc(r->pool, (apr_size_t)stats->nservers * sizeof(tls_tcpstat_server_t));
+    for (child = 0; child < stats->nchildren; ++child) {
+        for (i = 0; i < stats->nservers; ++i) {
+            tls_tcpstat_server_t *src = &stats->servers[child * stats->nservers + i];
+            tls_tcpstat_server_t *dest = &counts[i];
+
+            dest->conns += count_get(&src->conns);
+            dest->rtt_sum += count_get(&src->rtt_sum);
+            dest->rttvar_sum += count_get(&src->rttvar_sum);
+            max = apr_atomic_read32(&src->rtt_max);
+            if (max > dest->rtt_max) dest->rtt_max = max;
+            dest->retrans += count_get(&src->retrans);
+            dest->retrans_conns += count_get(&src->retrans_conns);
+            dest->rate_sum += count_get(&src->rate_sum);
+            dest->rate_conns += count_get(&src->rate_conns);
+        }
+    }
+
+    if (!(flags & AP_STATUS_SHORT)) {
+        ap_rputs("<hr>\n<h2>TLS TCP Statistics</h2>\n<table>\n"
+                 "<tr><th>server</th><th>connections</th><th>avg rtt (ms)</th>"
+                 "<th>avg rttvar (ms)</th><th>max rtt (ms)</th><th>retransmits</th>"
+                 "<th>conns w/ retransmits</th><th>avg delivery rate (KB/s)</th></tr>\n", r);
+    }
+    for (i = 0, s = ap_server_conf; s && i < stats->nservers; s = s->next) {
+        tls_tcpstat_server_t *st;
+
+        if (!tls_conf_server_get(s)->tcp_stats_slot) continue;
+        st = &counts[i++];
+        name = apr_psprintf(r->pool, "%s:%d", s->server_hostname? s->server_hostname : "default",
+                            s->port? (int)s->port : 443);
+        rtt = st->conns? st->rtt_sum / st->conns : 0;
+        rttvar = st->conns? st->rttvar_sum / st->conns : 0;
+        rate = st->rate_conns? st->rate_sum / st->rate_conns : 0;
+        if (flags & AP_STATUS_SHORT) {
+            ap_rprintf(r, "TLSTCPStats %s: conns=%" APR_UINT64_T_FMT " rtt=%" APR_UINT64_T_FMT
+                       " rttvar=%" APR_UINT64_T_FMT " rtt_max=%u retrans=%" APR_UINT64_T_FMT
+                       " retrans_conns=%" APR_UINT64_T_FMT " delivery_rate=%" APR_UINT64_T_FMT "\n",
+                       name, st->conns, rtt, rttvar, st->rtt_max, st->retrans,
+                       st->retrans_conns, rate);
+        }
+        else {
+            ap_rprintf(r, "<tr><td>%s</td><td>%" APR_UINT64_T_FMT "</td><td>%.1f</td>"
+                       "<td>%.1f</td><td>%.1f</td><td>%" APR_UINT64_T_FMT "</td>"
+                       "<td>%" APR_UINT64_T_FMT "</td><td>%" APR_UINT64_T_FMT "</td></tr>\n",
+                       ap_escape_html(r->pool, name), st->conns, (double)rtt / 1000.0,
+                       (double)rttvar / 1000.0, (double)st->rtt_max / 1000.0,
+                       st->retrans, st->retrans_conns, rate / 1024);
+        }
+    }
+    if (!(flags & AP_STATUS_SHORT)) {
+        ap_rputs("</table>\n", r);
+    }
+}
@@ -0,0 +1,42 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef tls_tcpstat_h
+#define tls_tcpstat_h
+
+/**
+ * Create the shared memory for `TLSTCPStats`, if enabled, and
+ * assign each server its slot.
+ */
+apr_status_t tls_tcpstat_post_config(apr_pool_t *p, apr_pool_t *ptemp, server_rec *s);
+
+/**
+ * The handshake on an incoming connection is done, sample its TCP state.
+ */
+void tls_tcpstat_handshake_done(conn_rec *c);
+
+/**
+ * The connection is about to be closed. Sample its TCP state again
+ * and add it to the statistics of its server. The connection's variables
+ * keep the sample from the handshake.
+ */
+int tls_tcpstat_pre_close(conn_rec *c);
+
+/**
+ * Report the TCP statistics of all servers for mod_status.
+ */
+void tls_tcpstat_status(request_rec *r, int flags);
+
+#endif /* tls_tcpstat_h */
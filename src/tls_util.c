@@ -16,12 +16,20 @@
 #include <assert.h>
 #include <apr_lib.h>
 #include <apr_file_info.h>
+#include <apr_portable.h>
 #include <apr_strings.h>
 
 #include <httpd.h>
 #include <http_core.h>
 #include <http_log.h>
 
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
 #include <rustls.h>
 
 #include "tls_proto.h"
@@ -365,3 +373,51 @@ apr_size_t tls_util_bb_print(char *buffer, apr_size_t bmax,
     return off;
 }
 
+#if defined(__linux__) && defined(TCP_INFO)
+/* The libc struct tcp_info stops at tcpi_total_retrans. The kernel has
+ * appended more since, its ABI places tcpi_delivery_rate (Linux 4.9+) here. */
+#define TLS_TCPI_DELIVERY_RATE_OFFSET   160
+
+typedef union {
+    struct tcp_info ti;
+    unsigned char raw[TLS_TCPI_DELIVERY_RATE_OFFSET + sizeof(apr_uint64_t)];
+    apr_uint64_t align;
+} tls_tcpi_buffer_t;
+#endif
+
+apr_status_t tls_util_tcp_info_get(conn_rec *c, tls_tcp_info_t *info)
+{
+#if defined(__linux__) && defined(TCP_INFO)
+    apr_socket_t *sock;
+    apr_os_sock_t fd;
+    tls_tcpi_buffer_t buf;
+    struct tcp_info *ti = &buf.ti;
+    socklen_t len = sizeof(buf);
+    apr_status_t rv;
+
+    memset(info, 0, sizeof(*info));
+    sock = ap_get_conn_socket(c->master? c->master : c);
+    if (!sock) return APR_ENOTSOCK;
+    rv = apr_os_sock_get(&fd, sock);
+    if (APR_SUCCESS != rv) return rv;
+    memset(&buf, 0, sizeof(buf));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &buf, &len) < 0) {
+        return APR_FROM_OS_ERROR(errno);
+    }
+    info->rtt = ti->tcpi_rtt;
+    info->rttvar = ti->tcpi_rttvar;
+    info->snd_cwnd = ti->tcpi_snd_cwnd;
+    info->snd_mss = ti->tcpi_snd_mss;
+    info->rcv_space = ti->tcpi_rcv_space;
+    info->total_retrans = ti->tcpi_total_retrans;
+    if (len >= sizeof(buf)) {
+        memcpy(&info->delivery_rate, buf.raw + TLS_TCPI_DELIVERY_RATE_OFFSET,
+               sizeof(info->delivery_rate));
+    }
+    return APR_SUCCESS;
+#else
+    (void)c;
+    memset(info, 0, sizeof(*info));
+    return APR_ENOTIMPL;
+#endif
+}
@@ -125,6 +125,26 @@ int tls_util_name_matches_server(const char *name, server_rec *s);
 apr_size_t tls_util_bucket_print(char *buffer, apr_size_t bmax,
                                  apr_bucket *b, const char *sep);
 
+/**
+ * A sample of the kernel's TCP state for a connection.
+ */
+typedef struct tls_tcp_info_t tls_tcp_info_t;
+struct tls_tcp_info_t {
+    apr_uint32_t rtt;                 /* smoothed round trip time in microseconds */
+    apr_uint32_t rttvar;              /* variance of the round trip time in microseconds */
+    apr_uint32_t snd_cwnd;            /* congestion window in segments */
+    apr_uint32_t snd_mss;             /* sender maximum segment size in bytes */
+    apr_uint32_t rcv_space;           /* receive window space in bytes */
+    apr_uint32_t total_retrans;       /* # of retransmitted segments */
+    apr_uint64_t delivery_rate;       /* recent delivery rate in bytes/s, 0 if unknown */
+};
+
+/**
+ * Get the TCP_INFO of the connection's socket, where the platform supports it.
+ * @return APR_SUCCESS, APR_ENOTIMPL if not supported or the failure of getsockopt().
+ */
+apr_status_t tls_util_tcp_info_get(conn_rec *c, tls_tcp_info_t *info);
+
 /**
  * Prints the brigade bucket types and lengths into the given buffer
  * up to bmax.
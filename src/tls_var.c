@@ -15,14 +15,17 @@
  */
 #include <assert.h>
 #include <apr_lib.h>
+#include <apr_optional.h>
 #include <apr_strings.h>
 
 #include <httpd.h>
+#include <http_config.h>
 #include <http_connection.h>
 #include <http_core.h>
 #include <http_main.h>
 #include <http_log.h>
 #include <ap_socache.h>
+#include <mod_log_config.h>
 
 #include <rustls.h>
 
@@ -147,6 +150,30 @@ static const char *var_get_server_cert(const tls_var_lookup_ctx_t *ctx)
     return pem;
 }
 
+static const char *var_get_tcp_info(const tls_var_lookup_ctx_t *ctx)
+{
+    const tls_tcp_info_t *info = ctx->cc->tcp_info;
+
+    /* only sampled when 'TLSTCPStats' is on and the platform supports it */
+    if (!info || !ctx->arg_s) return NULL;
+    if (!strcmp("rtt", ctx->arg_s)) {
+        return apr_psprintf(ctx->p, "%u", info->rtt);
+    }
+    else if (!strcmp("rttvar", ctx->arg_s)) {
+        return apr_psprintf(ctx->p, "%u", info->rttvar);
+    }
+    else if (!strcmp("retrans", ctx->arg_s)) {
+        return apr_psprintf(ctx->p, "%u", info->total_retrans);
+    }
+    else if (!strcmp("cwnd", ctx->arg_s)) {
+        return apr_psprintf(ctx->p, "%u", info->snd_cwnd);
+    }
+    else if (!strcmp("rate", ctx->arg_s)) {
+        return apr_psprintf(ctx->p, "%" APR_UINT64_T_FMT, info->delivery_rate);
+    }
+    return NULL;
+}
+
 typedef struct {
     const char *name;
     var_lookup* fn;
@@ -178,6 +205,11 @@ static const var_def_t VAR_DEFS[] = {
     { "SSL_CLIENT_CHAIN_8", var_get_client_cert, "chain", 8 },
     { "SSL_CLIENT_CHAIN_9", var_get_client_cert, "chain", 9 },
     { "SSL_SERVER_CERT", var_get_server_cert, NULL, 0 },
+    { "SSL_TCP_RTT", var_get_tcp_info, "rtt", 0 },
+    { "SSL_TCP_RTTVAR", var_get_tcp_info, "rttvar", 0 },
+    { "SSL_TCP_RETRANS", var_get_tcp_info, "retrans", 0 },
+    { "SSL_TCP_CWND", var_get_tcp_info, "cwnd", 0 },
+    { "SSL_TCP_DELIVERY_RATE", var_get_tcp_info, "rate", 0 },
 };
 
 static const char *const TlsAlwaysVars[] = {
@@ -395,3 +427,23 @@ int tls_var_request_fixup(request_rec *r)
 cleanup:
     return DECLINED;
 }
+
+static const char *log_handler_x(request_rec *r, char *a)
+{
+    const char *val = tls_var_lookup(r->pool, r->server, r->connection, r, a);
+    return (val && *val)? val : NULL;
+}
+
+void tls_var_pre_config(apr_pool_t *pconf)
+{
+    static char tag_x[] = "x";
+    APR_OPTIONAL_FN_TYPE(ap_register_log_handler) *log_pfn_register;
+
+    /* mod_ssl registers `%{name}x` itself and its lookup reaches ours
+     * through the ssl_var_lookup hook. Without it, we offer the format. */
+    if (ap_find_linked_module("mod_ssl.c")) return;
+    log_pfn_register = APR_RETRIEVE_OPTIONAL_FN(ap_register_log_handler);
+    if (log_pfn_register) {
+        log_pfn_register(pconf, tag_x, log_handler_x, 0);
+    }
+}
@@ -18,6 +18,12 @@
 
 void tls_var_init_lookup_hash(apr_pool_t *pool, apr_hash_t *map);
 
+/**
+ * Register the `%{name}x` format of mod_log_config for our variables,
+ * unless mod_ssl is loaded and does so.
+ */
+void tls_var_pre_config(apr_pool_t *pconf);
+
 /**
  * Callback for installation in Apache's 'ssl_var_lookup' hook to provide
  * SSL related variable lookups to other modules.
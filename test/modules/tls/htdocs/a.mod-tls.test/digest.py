@@ -0,0 +1,19 @@
+#!/usr/bin/env python3
+import hashlib
+import json
+import os
+import sys
+
+# answer with the length and sha256 of the request body
+length = int(os.environ.get('CONTENT_LENGTH', '0') or '0')
+digest = hashlib.sha256()
+received = 0
+while received < length:
+    data = sys.stdin.buffer.read(min(65536, length - received))
+    if not data:
+        break
+    digest.update(data)
+    received += len(data)
+
+print("Content-Type: application/json\n")
+print(json.dumps({'length': received, 'sha256': digest.hexdigest()}))
@@ -136,3 +136,138 @@ class TestConf:
         conf.add("TLSCiphersPrefer {cipher}".format(cipher=cipher))
         conf.install()
         assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("partition", [
+        "none",
+        "vhost1",
+        "vhost1 shmcb:mod_tls-sess-test(32000)",
+    ])
+    def test_tls_02_conf_session_partition_valid(self, env, partition):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSSessionCachePartition {partition}".format(partition=partition))
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("partition", [
+        "vhost/1",
+        "none shmcb:mod_tls-sess-test(32000)",
+        "vhost1 unknown:xxx",
+    ])
+    def test_tls_02_conf_session_partition_wrong(self, env, partition):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSSessionCachePartition {partition}".format(partition=partition))
+        conf.install()
+        assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("count", ["0", "1", "5"])
+    def test_tls_02_conf_prewarm_valid(self, env, count):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSPrewarm {count}".format(count=count))
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("count", ["-1", "abc", "1000"])
+    def test_tls_02_conf_prewarm_wrong(self, env, count):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSPrewarm {count}".format(count=count))
+        conf.install()
+        assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("recorder", ["0", "64", "64 200ms", "16 2s"])
+    def test_tls_02_conf_recorder_valid(self, env, recorder):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSFlightRecorder {recorder}".format(recorder=recorder))
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("recorder", ["-1", "many", "64 soon", "64 0", "64 -5s"])
+    def test_tls_02_conf_recorder_wrong(self, env, recorder):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSFlightRecorder {recorder}".format(recorder=recorder))
+        conf.install()
+        assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("pipeline", ["0", "4", "4 8"])
+    def test_tls_02_conf_pipeline_valid(self, env, pipeline):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSPipeline {pipeline}".format(pipeline=pipeline))
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("pipeline", ["-1", "x", "4 0", "4 x"])
+    def test_tls_02_conf_pipeline_wrong(self, env, pipeline):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSPipeline {pipeline}".format(pipeline=pipeline))
+        conf.install()
+        assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("tune", ["off", "32k 4m", "16384 65536"])
+    def test_tls_02_conf_autotune_valid(self, env, tune):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSBufferAutotune {tune}".format(tune=tune))
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("tune", ["on", "32k", "4m 32k", "32x 4m", "0 4m"])
+    def test_tls_02_conf_autotune_wrong(self, env, tune):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSBufferAutotune {tune}".format(tune=tune))
+        conf.install()
+        assert env.apache_fail() == 0
+
+    def test_tls_02_conf_crypto_provider_default(self, env):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSCryptoProvider default")
+        conf.add("TLSProxyCryptoProvider default")
+        conf.add("TLSCryptoBenchmark off")
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("name, value", [
+        ("TLSCryptoProvider", "wrong"),
+        ("TLSProxyCryptoProvider", "wrong"),
+        ("TLSCryptoBenchmark", "maybe"),
+    ])
+    def test_tls_02_conf_crypto_provider_wrong(self, env, name, value):
+        conf = TlsTestConf(env=env)
+        conf.add(f"{name} {value}")
+        conf.install()
+        assert env.apache_fail() == 0
+
+    def test_tls_02_conf_hs_limit_valid(self, env):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSHandshakeLimit 10 20")
+        conf.add("TLSHandshakeLimitAction delay 500ms 8")
+        conf.add("TLSHandshakeLimitPrefix 24 56")
+        conf.add("TLSHandshakeLimitAllow 127.0.0.1 10.0.0.0/8 ::1")
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @pytest.mark.parametrize("name, value", [
+        ("TLSHandshakeLimit", "wrong"),
+        ("TLSHandshakeLimit", "10 0"),
+        ("TLSHandshakeLimitAction", "maybe"),
+        ("TLSHandshakeLimitAction", "reject 1s"),
+        ("TLSHandshakeLimitAction", "delay 1s 0"),
+        ("TLSHandshakeLimitPrefix", "33"),
+        ("TLSHandshakeLimitPrefix", "24 129"),
+        ("TLSHandshakeLimitAllow", "not-an-address"),
+    ])
+    def test_tls_02_conf_hs_limit_wrong(self, env, name, value):
+        conf = TlsTestConf(env=env)
+        conf.add(f"{name} {value}")
+        conf.install()
+        assert env.apache_fail() == 0
+
+    @pytest.mark.parametrize("value", ["on", "off"])
+    def test_tls_02_conf_tcp_stats_valid(self, env, value):
+        conf = TlsTestConf(env=env)
+        conf.add(f"TLSTCPStats {value}")
+        conf.install()
+        assert env.apache_restart() == 0
+
+    def test_tls_02_conf_tcp_stats_wrong(self, env):
+        conf = TlsTestConf(env=env)
+        conf.add("TLSTCPStats maybe")
+        conf.install()
+        assert env.apache_fail() == 0
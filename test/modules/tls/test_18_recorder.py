@@ -0,0 +1,38 @@
+import pytest
+
+from .conf import TlsTestConf
+
+
+class TestRecorder:
+
+    @pytest.fixture(autouse=True, scope='class')
+    def _class_scope(self, env):
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "TLSFlightRecorder 64",
+                "<Location /tls-recorder>",
+                "  SetHandler tls-flight-recorder",
+                "</Location>",
+            ],
+            env.domain_b: "TLSProtocol TLSv1.3+",
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        assert env.apache_restart() == 0
+
+    def test_tls_18_recorder_failed(self, env):
+        # handshakes failing on the protocol version are recorded
+        for _ in range(5):
+            r = env.tls_get(env.domain_b, "/index.json", options=["--tls-max", "1.2"])
+            assert r.exit_code != 0
+        # each child has its own recorder, ask until we hit one that saw them
+        found = False
+        for _ in range(20):
+            r = env.tls_get(env.domain_a, "/tls-recorder")
+            assert r.exit_code == 0, r.stderr
+            assert r.stdout.startswith("# pid "), r.stdout
+            if "sni=b.mod-tls.test" in r.stdout:
+                found = True
+                break
+        assert found, r.stdout
+        env.httpd_error_log.ignore_recent(matches=[r'.*TLS.*'])
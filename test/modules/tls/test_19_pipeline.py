@@ -0,0 +1,58 @@
+import os
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from .conf import TlsTestConf
+from .test_04_get import mk_text_file
+
+
+class TestPipeline:
+
+    @pytest.fixture(autouse=True, scope='class')
+    def _class_scope(self, env):
+        # a single helper, so concurrent downloads also take the
+        # path without the pipeline
+        conf = TlsTestConf(env=env, extras={
+            'base': "TLSPipeline 1 2",
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        docs_a = os.path.join(env.server_docs_dir, env.domain_a)
+        mk_text_file(os.path.join(docs_a, "1m.txt"), 8000)
+        mk_text_file(os.path.join(docs_a, "10m.txt"), 80000)
+        assert env.apache_restart() == 0
+
+    def _check_get(self, env, fname, flen, tag, options=None, offset=0):
+        docs_a = os.path.join(env.server_docs_dir, env.domain_a)
+        r = env.tls_get(env.domain_a, "/{0}".format(fname), options=options)
+        assert r.exit_code == 0, r.stderr
+        assert len(r.stdout) == flen
+        with open(os.path.join(docs_a, fname)) as fd:
+            fd.seek(offset)
+            expected = fd.read(flen)
+        pout = os.path.join(docs_a, "{0}.{1}.out".format(fname, tag))
+        with open(pout, 'w') as fd:
+            fd.write(r.stdout)
+        assert r.stdout == expected, "differences found in {0}".format(pout)
+
+    @pytest.mark.parametrize("fname, flen", [
+        ("1m.txt", 1000 * 1024),
+        ("10m.txt", 10000 * 1024),
+    ])
+    def test_tls_19_get(self, env, fname, flen):
+        self._check_get(env, fname, flen, "pipe")
+
+    def test_tls_19_get_range(self, env):
+        # an offset that is not page aligned
+        self._check_get(env, "10m.txt", 5 * 1024 * 1024, "range",
+                        options=["-r", "1001-5243880"], offset=1001)
+
+    def test_tls_19_get_parallel(self, env):
+        # more downloads than helpers, the others encrypt in their worker
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            futures = [executor.submit(self._check_get, env, "10m.txt",
+                                       10000 * 1024, "par{0}".format(i))
+                       for i in range(4)]
+            for f in futures:
+                f.result()
@@ -0,0 +1,54 @@
+import re
+
+import pytest
+
+from .conf import TlsTestConf
+
+
+class TestProvider:
+
+    RE_BENCH = re.compile(r'.*crypto provider (?P<name>\S+): \d+ handshakes/s.*')
+
+    def _providers(self, env):
+        # the benchmark logs a line for each provider available
+        conf = TlsTestConf(env=env, extras={
+            'base': "TLSCryptoBenchmark on",
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(0, 2)
+            pos = fd.tell()
+        assert env.apache_restart() == 0
+        names = set()
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(pos)
+            for line in fd:
+                m = self.RE_BENCH.match(line)
+                if m:
+                    names.add(m.group('name'))
+        return sorted(names)
+
+    def test_tls_20_provider_list(self, env):
+        names = self._providers(env)
+        assert len(names) > 0, f"{names}"
+        for name in names:
+            assert name in ['default', 'aws-lc-rs', 'ring'], f"{names}"
+        # "default" is one of the others and only measured when alone
+        if 'default' in names:
+            assert names == ['default'], f"{names}"
+
+    def test_tls_20_provider_select(self, env):
+        names = [n for n in self._providers(env) if n != 'default']
+        if not names:
+            pytest.skip("rustls has no other crypto provider than its default")
+        for name in names:
+            conf = TlsTestConf(env=env, extras={
+                env.domain_a: f"TLSCryptoProvider {name}",
+            })
+            conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+            conf.install()
+            assert env.apache_restart() == 0
+            r = env.tls_get(env.domain_a, "/index.json")
+            assert r.exit_code == 0, r.stderr
+            assert r.json == {'domain': env.domain_a}, f"{name}: {r.stdout}"
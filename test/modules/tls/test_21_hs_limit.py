@@ -0,0 +1,50 @@
+import re
+
+import pytest
+
+from .conf import TlsTestConf
+
+
+class TestHandshakeLimit:
+
+    def _setup(self, env, action):
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "TLSHandshakeLimit 1 1",
+                f"TLSHandshakeLimitAction {action}",
+                "<Location /server-status>",
+                "  SetHandler server-status",
+                "</Location>",
+            ],
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        assert env.apache_restart() == 0
+
+    def _count(self, env, name):
+        # ask over plain http, a TLS handshake would be limited as well
+        r = env.curl_get(f"http://localhost:{env.http_port}/server-status?auto")
+        assert r.exit_code == 0, r.stderr
+        m = re.search(r'^{0}: (\d+)$'.format(name), r.stdout, re.MULTILINE)
+        assert m, r.stdout
+        return int(m.group(1))
+
+    def test_tls_21_reject(self, env):
+        self._setup(env, "reject")
+        failed = 0
+        for _ in range(5):
+            r = env.tls_get(env.domain_a, "/index.json")
+            if r.exit_code != 0:
+                failed += 1
+        assert failed > 0
+        assert self._count(env, "TLSHandshakesRejected") == failed
+        assert self._count(env, "TLSHandshakesDelayed") == 0
+        env.httpd_error_log.ignore_recent(matches=[r'.*TLSHandshakeLimit.*'])
+
+    def test_tls_21_delay(self, env):
+        self._setup(env, "delay 2s")
+        for _ in range(3):
+            r = env.tls_get(env.domain_a, "/index.json")
+            assert r.exit_code == 0, r.stderr
+        assert self._count(env, "TLSHandshakesDelayed") > 0
+        assert self._count(env, "TLSHandshakesRejected") == 0
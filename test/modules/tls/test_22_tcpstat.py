@@ -0,0 +1,57 @@
+import os
+import re
+import sys
+import time
+
+import pytest
+
+from .conf import TlsTestConf
+
+
+@pytest.mark.skipif(not sys.platform.startswith('linux'), reason="TCP_INFO is Linux only")
+class TestTcpStats:
+
+    @pytest.fixture(autouse=True, scope='class')
+    def _class_scope(self, env):
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "TLSTCPStats on",
+                'LogFormat "%h %{SSL_TCP_RTT}x %{SSL_TCP_CWND}x" tcpstat',
+                f'CustomLog "{self._log_path(env)}" tcpstat',
+                "<Location /server-status>",
+                "  SetHandler server-status",
+                "</Location>",
+            ],
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        assert env.apache_restart() == 0
+
+    @staticmethod
+    def _log_path(env):
+        return os.path.join(env.server_logs_dir, "tcpstat_log")
+
+    def test_tls_22_log_rtt(self, env):
+        r = env.tls_get(env.domain_a, "/index.json")
+        assert r.exit_code == 0, r.stderr
+        with open(self._log_path(env)) as fd:
+            lines = fd.readlines()
+        assert len(lines) > 0
+        m = re.match(r'^\S+ (\d+) (\d+)$', lines[-1].strip())
+        assert m, lines[-1]
+        assert int(m.group(2)) > 0, lines[-1]
+
+    def test_tls_22_status(self, env):
+        r = env.tls_get(env.domain_a, "/index.json")
+        assert r.exit_code == 0, r.stderr
+        # the connection is counted when it closes, which may take a moment
+        for _ in range(20):
+            conns = 0
+            r = env.curl_get(f"http://localhost:{env.http_port}/server-status?auto")
+            assert r.exit_code == 0, r.stderr
+            for m in re.finditer(r'^TLSTCPStats \S+: conns=(\d+) ', r.stdout, re.MULTILINE):
+                conns += int(m.group(1))
+            if conns > 0:
+                break
+            time.sleep(.1)
+        assert conns > 0, r.stdout
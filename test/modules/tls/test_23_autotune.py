@@ -0,0 +1,58 @@
+import os
+import re
+import sys
+
+import pytest
+
+from .conf import TlsTestConf
+from .test_04_get import mk_text_file
+
+
+@pytest.mark.skipif(not sys.platform.startswith('linux'), reason="TCP_INFO is Linux only")
+class TestAutotune:
+
+    RE_TUNE = re.compile(r'.*autotune: .* fout_max=(?P<fout_max>\d+) flush=(?P<flush>\d+)')
+    RE_PASS = re.compile(r'.*fout_pass_tls_to_net: (?P<n>\d+) bytes')
+
+    @pytest.fixture(autouse=True, scope='class')
+    def _class_scope(self, env):
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "TLSBufferAutotune 16k 1m",
+                "LogLevel tls:trace3",
+            ],
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        docs_a = os.path.join(env.server_docs_dir, env.domain_a)
+        mk_text_file(os.path.join(docs_a, "10m.txt"), 80000)
+        assert env.apache_restart() == 0
+
+    def test_tls_23_download(self, env):
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(0, os.SEEK_END)
+            pos = fd.tell()
+        r = env.tls_get(env.domain_a, "/10m.txt")
+        assert r.exit_code == 0, r.stderr
+        assert len(r.stdout) == 10000 * 1024
+        tunes = []
+        passed = []
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(pos)
+            for line in fd:
+                m = self.RE_TUNE.match(line)
+                if m:
+                    tunes.append((int(m.group('fout_max')), int(m.group('flush'))))
+                    continue
+                m = self.RE_PASS.match(line)
+                if m and tunes:
+                    passed.append(int(m.group('n')))
+        assert len(tunes) > 0
+        for fout_max, flush in tunes:
+            assert 16 * 1024 <= fout_max <= 1024 * 1024, f"{tunes}"
+            assert 16 * 1024 <= flush <= 1024 * 1024, f"{tunes}"
+        # The window on loopback is far larger than the untuned 64KB. The
+        # network then gets larger writes than without tuning.
+        assert max(tunes)[0] > 128 * 1024, f"{tunes}"
+        assert len(passed) > 0
+        assert max(passed) > 128 * 1024, f"{max(passed)}"
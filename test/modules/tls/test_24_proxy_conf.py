@@ -0,0 +1,90 @@
+import os
+import re
+import shutil
+
+import pytest
+
+from .conf import TlsTestConf
+
+
+class TestProxyConf:
+
+    RE_ADD = re.compile(r'.* (?P<name>\S+): adding proxy_conf to globals')
+    RE_SHARE = re.compile(r'.* (?P<name>\S+): sharing proxy_conf defined in (?P<owner>\S+)')
+
+    def _restart(self, env, conf):
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(0, os.SEEK_END)
+            pos = fd.tell()
+        assert env.apache_restart() == 0
+        added = set()
+        shared = {}
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(pos)
+            for line in fd:
+                m = self.RE_ADD.match(line)
+                if m:
+                    added.add(m.group('name'))
+                    continue
+                m = self.RE_SHARE.match(line)
+                if m:
+                    shared[m.group('name')] = m.group('owner')
+        return added, shared
+
+    def _proxy_base(self, env):
+        return [
+            "LogLevel tls:trace3",
+            "TLSProxyEngine on",
+            f"TLSProxyCA {env.ca.cert_file}",
+            "ProxyPreserveHost on",
+        ]
+
+    def test_tls_24_proxy_conf_shared(self, env):
+        # vhosts repeating the settings of the base server use its config
+        conf = TlsTestConf(env=env, extras={
+            'base': self._proxy_base(env),
+            env.domain_a: [
+                "TLSProxyEngine on",
+                f"TLSProxyCA {env.ca.cert_file}",
+                f"ProxyPass /proxy-tls/ https://127.0.0.1:{env.https_port}/",
+            ],
+            env.domain_b: [
+                "TLSProxyEngine on",
+                f"TLSProxyCA {env.ca.cert_file}",
+            ],
+        })
+        added, shared = self._restart(env, conf)
+        assert len(added) == 1, f"{added}"
+        owner = added.pop()
+        assert shared.get(env.domain_a) == owner, f"{shared}"
+        assert shared.get(env.domain_b) == owner, f"{shared}"
+        data = env.tls_get_json(env.domain_a, "/proxy-tls/index.json")
+        assert data == {'domain': env.domain_a}
+
+    def test_tls_24_proxy_conf_other_ca(self, env):
+        # a vhost with another TLSProxyCA has its own config, a vhost
+        # without any settings inherits the one of the base server
+        other_ca = os.path.join(env.server_dir, 'proxy-ca.pem')
+        shutil.copyfile(env.ca.cert_file, other_ca)
+        conf = TlsTestConf(env=env, extras={
+            'base': self._proxy_base(env),
+            env.domain_a: [
+                f"ProxyPass /proxy-tls/ https://127.0.0.1:{env.https_port}/",
+            ],
+            env.domain_b: [
+                f"TLSProxyCA {other_ca}",
+                f"ProxyPass /proxy-tls/ https://127.0.0.1:{env.https_port}/",
+            ],
+        })
+        added, shared = self._restart(env, conf)
+        assert env.domain_b in added, f"{added}"
+        assert len(added) == 2, f"{added}"
+        owner = (added - {env.domain_b}).pop()
+        assert shared.get(env.domain_a) == owner, f"{shared}"
+        # both work, the inherited config and the own one
+        data = env.tls_get_json(env.domain_a, "/proxy-tls/index.json")
+        assert data == {'domain': env.domain_a}
+        data = env.tls_get_json(env.domain_b, "/proxy-tls/index.json")
+        assert data == {'domain': env.domain_b}
@@ -0,0 +1,46 @@
+import os
+import re
+import time
+
+from .conf import TlsTestConf
+
+
+class TestPrewarm:
+
+    RE_KEY = re.compile(r'.*prewarm key \d+ of (?P<name>\S+), type (?P<type>\S+)')
+
+    def test_tls_25_prewarm_key_types(self, env):
+        # domain_a has an RSA certificate, domain_b an ECDSA P-256 and an RSA one
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "TLSPrewarm 2",
+                "LogLevel tls:trace1",
+            ],
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        with open(env.httpd_error_log.path) as fd:
+            fd.seek(0, os.SEEK_END)
+            pos = fd.tell()
+        assert env.apache_restart() == 0
+        # children prewarm when they start, have one serve a request
+        r = env.tls_get(env.domain_a, "/index.json")
+        assert r.exit_code == 0, r.stderr
+        types = {}
+        end = time.time() + 5
+        while time.time() < end:
+            with open(env.httpd_error_log.path) as fd:
+                fd.seek(pos)
+                for line in fd:
+                    m = self.RE_KEY.match(line)
+                    if m:
+                        types.setdefault(m.group('name'), set()).add(m.group('type'))
+            if 'ec-p256' in types.get(env.domain_b, set()):
+                break
+            time.sleep(.1)
+        # keys of the same type are warmed once, the RSA key of domain_b is
+        # the same type as the one of domain_a and only warmed for the first.
+        all_types = set().union(*types.values()) if types else set()
+        assert 'unknown' not in all_types, f"{types}"
+        assert all_types == {'rsa', 'ec-p256'}, f"{types}"
+        assert 'ec-p256' in types.get(env.domain_b, set()), f"{types}"
@@ -0,0 +1,59 @@
+import hashlib
+import os
+
+import pytest
+
+from .conf import TlsTestConf
+from .test_04_get import mk_text_file
+
+
+class TestBulk:
+
+    @pytest.fixture(autouse=True, scope='class')
+    def _class_scope(self, env):
+        conf = TlsTestConf(env=env)
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        docs_a = os.path.join(env.server_docs_dir, env.domain_a)
+        mk_text_file(os.path.join(docs_a, "50m.txt"), 400000)
+        assert env.apache_restart() == 0
+
+    def _digest(self, fpath, start=0, length=None):
+        d = hashlib.sha256()
+        with open(fpath, 'rb') as fd:
+            fd.seek(start)
+            d.update(fd.read() if length is None else fd.read(length))
+        return d.hexdigest()
+
+    def test_tls_26_get_large(self, env):
+        fpath = os.path.join(env.server_docs_dir, env.domain_a, "50m.txt")
+        r = env.tls_get(env.domain_a, "/50m.txt")
+        assert r.exit_code == 0, r.stderr
+        assert len(r.stdout) == os.path.getsize(fpath)
+        assert hashlib.sha256(r.stdout.encode()).hexdigest() == self._digest(fpath)
+
+    def test_tls_26_get_range(self, env):
+        # a range that does not start on a page or chunk boundary
+        fpath = os.path.join(env.server_docs_dir, env.domain_a, "50m.txt")
+        start, length = 1001, 10 * 1024 * 1024 + 17
+        r = env.tls_get(env.domain_a, "/50m.txt", options=[
+            "-r", f"{start}-{start + length - 1}"
+        ])
+        assert r.exit_code == 0, r.stderr
+        assert len(r.stdout) == length
+        assert hashlib.sha256(r.stdout.encode()).hexdigest() == \
+            self._digest(fpath, start, length)
+
+    @pytest.mark.parametrize("size", [
+        1024 * 1024, 20 * 1024 * 1024 + 123
+    ])
+    def test_tls_26_post_large(self, env, size):
+        fpath = os.path.join(env.gen_dir, f"post-{size}.bin")
+        with open(fpath, 'wb') as fd:
+            fd.write(os.urandom(size))
+        r = env.tls_get(env.domain_a, "/digest.py", options=[
+            "--data-binary", f"@{fpath}",
+            "-H", "Content-Type: application/octet-stream",
+        ])
+        assert r.exit_code == 0, r.stderr
+        assert r.json == {'length': size, 'sha256': self._digest(fpath)}, r.stdout
@@ -0,0 +1,59 @@
+import re
+
+from .conf import TlsTestConf
+
+
+class TestSessionPartition:
+
+    def _status(self, env):
+        # ask over plain http, the counts are not to include this request
+        r = env.curl_get(f"http://localhost:{env.http_port}/server-status?auto")
+        assert r.exit_code == 0, r.stderr
+        caches = {}
+        name = None
+        for line in r.stdout.splitlines():
+            m = re.match(r'^TLSSessionCachePartition: (\S+)$', line)
+            if m:
+                name = m.group(1)
+                caches[name] = {}
+                continue
+            m = re.match(r'^(Cache\w+): (\d+)$', line)
+            if m and name:
+                caches[name][m.group(1)] = int(m.group(2))
+        return caches
+
+    def test_tls_27_partition_fill(self, env):
+        # a partition just large enough for shmcb, filled with sessions
+        conf = TlsTestConf(env=env, extras={
+            'base': [
+                "<Location /server-status>",
+                "  SetHandler server-status",
+                "</Location>",
+            ],
+            env.domain_b: "TLSSessionCachePartition small shmcb:mod_tls-sess-small(8192)",
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        assert env.apache_restart() == 0
+        for _ in range(40):
+            env.openssl_client(env.domain_b, extra_args=["-reconnect", "-tls1_2"])
+        caches = self._status(env)
+        assert 'small' in caches, f"{caches}"
+        small = caches['small']
+        assert small.get('CacheStoreCount', 0) >= 40, f"{small}"
+        assert small.get('CacheRetrieveHitCount', 0) > 0, f"{small}"
+        assert small.get('CacheDiscardCount', 0) > 0, f"{small}"
+        # none of it went into the global cache
+        for name, counts in caches.items():
+            if name != 'small':
+                assert counts.get('CacheStoreCount', 0) == 0, f"{caches}"
+
+    def test_tls_27_partition_fail(self, env):
+        # shmcb refuses sizes below 8192 bytes, the server must not start
+        conf = TlsTestConf(env=env, extras={
+            env.domain_b: "TLSSessionCachePartition tiny shmcb:mod_tls-sess-tiny(100)",
+        })
+        conf.add_tls_vhosts(domains=[env.domain_a, env.domain_b])
+        conf.install()
+        assert env.apache_fail() == 0
+        env.httpd_error_log.ignore_recent(matches=[r'.*session cache partition tiny.*'])